@@ -1,280 +1,524 @@
 #include "DCEL.h"
 #include "geometry.h"
+#include "sweep.h"
+#include "parser.h"
+#include "writer.h"
+#include "stats.h"
 #include <iostream>
 #include <cstdio>
+#include <algorithm>
+#include <unistd.h>
 
 // estrategia de indexacao:
 // - entrada: indices baseados em 1 (vertices 1, 2, 3, ...)
-// - interno: indices baseados em 0 (arrays 0, 1, 2, ...)  
+// - interno: indices baseados em 0 (arrays 0, 1, 2, ...)
 // - saida: indices baseados em 1 (conversao de volta)
 
-// point methods
-bool Point::operator==(const Point& other) const {
-    return x == other.x && y == other.y;
-}
+template <typename Coord>
+bool BasicDCEL<Coord>::loadFromInput(const char* path) {
+    // sem caminho, le a entrada padrao
+    MeshParser parser;
+    bool opened = path ? parser.openFile(path) : parser.openStdin();
 
-bool Point::operator!=(const Point& other) const {
-    return !(*this == other);
+    MeshData mesh;
+    bool parsed;
+    {
+        Stats::Timer timer(Stats::PARSE);
+        parsed = opened && parser.parse(mesh);
+    }
+    if (!parsed) {
+        fprintf(stderr, "erro: %s\n", parser.getError().c_str());
+        return false;
+    }
+    return loadFromMesh(mesh);
 }
 
-// half-edge methods
-Vertex* HalfEdge::destination() const {
-    return twin ? twin->origin : nullptr;
+template <typename Coord>
+bool BasicDCEL<Coord>::checkCoordinates(const MeshData& mesh) {
+    // fora de (-LIMIT, LIMIT) o predicado de orientacao desta largura nao eh exato
+    for (size_t v = 0; v < mesh.getVertexCount(); v++) {
+        if (!fitsCoordinate<Coord>(mesh.vertexX[v]) || !fitsCoordinate<Coord>(mesh.vertexY[v])) {
+            fprintf(stderr, "erro: vertice %zu fora do intervalo de coordenadas de %zu bits\n",
+                    v + 1, sizeof(Coord) * 8);
+            return false;
+        }
+    }
+    return true;
 }
 
-Point HalfEdge::getSegmentStart() const {
-    return origin ? origin->position : Point();
-}
+template <typename Coord>
+bool BasicDCEL<Coord>::loadFromMesh(const MeshData& mesh) {
+    if (!checkCoordinates(mesh)) {
+        return false;
+    }
+
+    vertexX.assign(mesh.vertexX.begin(), mesh.vertexX.end());
+    vertexY.assign(mesh.vertexY.begin(), mesh.vertexY.end());
+    vertexEdge.assign(vertexX.size(), NONE);
+    faceEdge.assign(mesh.getFaceCount(), NONE);
+    edgeOrigin.clear();
+    edgeFace.clear();
+    vertexSource.clear();
+    edgeSource.clear();
+    validated = false;
+    resetEditState();
 
-Point HalfEdge::getSegmentEnd() const {
-    return destination() ? destination()->position : Point();
+    return constructDCEL(mesh);
 }
 
-bool DCEL::loadFromInput() {
-    // le cabecalho: numero de vertices e faces
-    int nVertices, nFaces;
-    if (scanf("%d %d", &nVertices, &nFaces) != 2) {
+template <typename Coord>
+bool BasicDCEL<Coord>::constructDCEL(const MeshData& mesh) {
+    if (!createHalfEdges(mesh)) {
         return false;
     }
-    
-    // pre-aloca memoria para melhor performance
-    vertices.reserve(nVertices);
-    for (int i = 0; i < nVertices; i++) {
-        int x, y;
-        if (scanf("%d %d", &x, &y) != 2) {
-            return false;
+    linkHalfEdgeChains();
+    return true;
+}
+
+namespace {
+    // abaixo disso radixSortByKey ordena por comparacao
+    const size_t SMALL_SORT = 4096;
+
+    // radix sort LSD estavel de chaves de 64 bits (levando junto o indice associado),
+    // em digitos de 16 bits; passadas em que o digito eh igual para todas as chaves
+    // sao puladas, entao malhas com menos de 65536 vertices ordenam em 2 passadas.
+    // keyBuffer e valueBuffer sao a area de troca entre as passadas
+    void radixSortByKey(std::vector<uint64_t>& keys, std::vector<uint32_t>& values,
+                        std::vector<uint64_t>& keyBuffer, std::vector<uint32_t>& valueBuffer) {
+        const int DIGIT_BITS = 16;
+        const size_t RADIX = size_t(1) << DIGIT_BITS;
+        const int PASSES = 64 / DIGIT_BITS;
+        size_t n = keys.size();
+        if (n < 2) return;
+
+        // poucas chaves (malhas pequenas, como na validacao em lote): zerar os
+        // histogramas de 2^16 entradas custa mais que ordenar por comparacao. os
+        // valores entram no desempate, o que da a mesma ordem da versao estavel
+        // quando eles sao crescentes, como os indices de matchTwins
+        if (n < SMALL_SORT) {
+            std::vector<std::pair<uint64_t, uint32_t>> pairs(n);
+            for (size_t i = 0; i < n; i++) {
+                pairs[i] = {keys[i], values[i]};
+            }
+            std::sort(pairs.begin(), pairs.end());
+            for (size_t i = 0; i < n; i++) {
+                keys[i] = pairs[i].first;
+                values[i] = pairs[i].second;
+            }
+            return;
         }
-        vertices.push_back(std::make_unique<Vertex>(Point(x, y), i));
-    }
-    
-    faces.reserve(nFaces);
-    faceVertexIndices.reserve(nFaces);
-    
-    // le cada face como sequencia de vertices ate encontrar quebra de linha
-    for (int i = 0; i < nFaces; i++) {
-        faces.push_back(std::make_unique<Face>(i));
-        
-        std::vector<int> faceVertices;
-        int vertexIndex;
-        
-        while (scanf("%d", &vertexIndex) == 1) {
-            faceVertices.push_back(inputToInternal(vertexIndex)); // converte entrada 1-based para interno 0-based
-            if (getchar() == '\n') break;
+
+        // histogramas de todos os digitos em uma unica leitura
+        std::vector<uint32_t> counts(PASSES * RADIX, 0);
+        for (uint64_t key : keys) {
+            for (int d = 0; d < PASSES; d++) {
+                counts[d * RADIX + ((key >> (d * DIGIT_BITS)) & (RADIX - 1))]++;
+            }
+        }
+
+        keyBuffer.resize(n);
+        valueBuffer.resize(n);
+        for (int d = 0; d < PASSES; d++) {
+            uint32_t* count = &counts[d * RADIX];
+            int shift = d * DIGIT_BITS;
+            if (count[(keys[0] >> shift) & (RADIX - 1)] == n) continue;
+
+            // converte contagens em posicoes iniciais
+            uint32_t offset = 0;
+            for (size_t digit = 0; digit < RADIX; digit++) {
+                uint32_t c = count[digit];
+                count[digit] = offset;
+                offset += c;
+            }
+
+            for (size_t i = 0; i < n; i++) {
+                uint32_t pos = count[(keys[i] >> shift) & (RADIX - 1)]++;
+                keyBuffer[pos] = keys[i];
+                valueBuffer[pos] = values[i];
+            }
+            keys.swap(keyBuffer);
+            values.swap(valueBuffer);
         }
-        
-        faceVertexIndices.push_back(std::move(faceVertices));
     }
-    
-    return constructDCEL();
+
+    // aresta geometrica normalizada (min, max) empacotada em 64 bits
+    uint64_t edgeKey(uint32_t from, uint32_t to) {
+        return ((uint64_t)std::min(from, to) << 32) | std::max(from, to);
+    }
 }
 
-bool DCEL::constructDCEL() {
-    if (!createHalfEdges()) {
-        return false;
+template <typename Coord>
+bool BasicDCEL<Coord>::createHalfEdges(const MeshData& mesh) {
+    // chave da aresta geometrica de cada half-edge, para encontrar twins
+    std::vector<uint64_t>& keys = scratch.keys;
+    keys.clear();
+
+    if (constructionThreads != 1) {
+        createHalfEdgesParallel(mesh, keys);
+    } else {
+        // cada aresta de face gera uma half-edge, entao o total eh conhecido
+        size_t totalEdges = 0;
+        for (size_t faceIdx = 0; faceIdx < faceEdge.size(); faceIdx++) {
+            size_t numVertices = mesh.faceStart[faceIdx + 1] - mesh.faceStart[faceIdx];
+            if (numVertices >= 3) {
+                totalEdges += numVertices;
+            }
+        }
+        edgeOrigin.reserve(totalEdges);
+        edgeFace.reserve(totalEdges);
+        keys.reserve(totalEdges);
+
+        // itera sobre cada face para criar suas half-edges
+        Stats::Timer timer(Stats::CREATE_HALF_EDGES);
+        for (size_t faceIdx = 0; faceIdx < faceEdge.size(); faceIdx++) {
+            addFaceHalfEdges((uint32_t)faceIdx, mesh.faceVertices.data() + mesh.faceStart[faceIdx],
+                             mesh.faceStart[faceIdx + 1] - mesh.faceStart[faceIdx], keys);
+        }
+    }
+    Stats::add(Stats::HALF_EDGES, edgeOrigin.size());
+
+    edgeNext.assign(edgeOrigin.size(), NONE);
+    edgePrev.assign(edgeOrigin.size(), NONE);
+
+    if (constructionThreads != 1) {
+        matchTwinsParallel(keys);
+    } else {
+        matchTwins(keys);
     }
-    linkHalfEdgeChains();
     return true;
 }
 
-bool DCEL::createHalfEdges() {
-    // indice para identificacao unica de cada half-edge
-    int halfEdgeIndex = 0;
-    
-    // itera sobre cada face para criar suas half-edges
-    for (size_t faceIdx = 0; faceIdx < faces.size(); faceIdx++) {
-        const auto& faceVertices = faceVertexIndices[faceIdx];
-        size_t numVertices = faceVertices.size();
-        
-        if (numVertices < 3) {
+template <typename Coord>
+void BasicDCEL<Coord>::addFaceHalfEdges(uint32_t faceIdx, const int* faceVertices, size_t numVertices,
+                            std::vector<uint64_t>& keys) {
+    if (numVertices < 3) {
+        return;
+    }
+
+    // cria half-edges para cada par de vertices consecutivos da face
+    for (size_t i = 0; i < numVertices; i++) {
+        // converte entrada 1-based para interno 0-based
+        int fromIdx = inputToInternal(faceVertices[i]);
+        int toIdx = inputToInternal(faceVertices[(i + 1) % numVertices]);
+
+        if (fromIdx < 0 || fromIdx >= (int)vertexX.size() ||
+            toIdx < 0 || toIdx >= (int)vertexX.size()) {
             continue;
         }
-        
-        // cria half-edges para cada par de vertices consecutivos da face
-        for (size_t i = 0; i < numVertices; i++) {
-            int fromIdx = faceVertices[i];
-            int toIdx = faceVertices[(i + 1) % numVertices];
-            
-            if (fromIdx < 0 || fromIdx >= (int)vertices.size() ||
-                toIdx < 0 || toIdx >= (int)vertices.size()) {
-                continue;
-            }
-            
-            // chave para identificar arestas gemeas (twins)
-            EdgeKey key(fromIdx, toIdx);
-            
-            auto halfEdge = std::make_unique<HalfEdge>();
-            halfEdge->index = halfEdgeIndex++;
-            halfEdge->origin = vertices[fromIdx].get();
-            halfEdge->incidentFace = faces[faceIdx].get();
-            
-            // garante que cada vertice tenha pelo menos uma half-edge incidente
-            if (!vertices[fromIdx]->incidentEdge) {
-                vertices[fromIdx]->incidentEdge = halfEdge.get();
-            }
-            
-            // define a primeira half-edge como componente externo da face
-            if (!faces[faceIdx]->outerComponent) {
-                faces[faceIdx]->outerComponent = halfEdge.get();
-            }
-            
-            HalfEdge* hePtr = halfEdge.get();
-            halfEdges.push_back(std::move(halfEdge));
-            
-            // mapeia half-edges para encontrar twins posteriormente
-            if (edgeMap.find(key) == edgeMap.end()) {
-                edgeMap[key] = {hePtr, nullptr};
-            } else {
-                auto& edgePair = edgeMap[key];
-                if (edgePair.first->origin->index == fromIdx) {
-                    edgePair.second = hePtr;
-                } else {
-                    edgePair.second = edgePair.first;
-                    edgePair.first = hePtr;
-                }
-            }
+
+        // indice para identificacao unica de cada half-edge
+        uint32_t he = (uint32_t)edgeOrigin.size();
+        edgeOrigin.push_back((uint32_t)fromIdx);
+        edgeFace.push_back(faceIdx);
+        keys.push_back(edgeKey((uint32_t)fromIdx, (uint32_t)toIdx));
+
+        // garante que cada vertice tenha pelo menos uma half-edge incidente
+        if (vertexEdge[fromIdx] == NONE) {
+            vertexEdge[fromIdx] = he;
+        }
+
+        // define a primeira half-edge como componente externo da face
+        if (faceEdge[faceIdx] == NONE) {
+            faceEdge[faceIdx] = he;
+        }
+    }
+}
+
+template <typename Coord>
+void BasicDCEL<Coord>::matchTwins(std::vector<uint64_t>& keys) {
+    Stats::Timer timer(Stats::MATCH_TWINS);
+
+    // ordena as half-edges pela aresta geometrica; a ordenacao eh estavel, entao
+    // dentro de cada aresta elas aparecem na ordem de criacao
+    std::vector<uint32_t>& order = scratch.order;
+    order.resize(keys.size());
+    for (uint32_t he = 0; he < order.size(); he++) {
+        order[he] = he;
+    }
+    radixSortByKey(keys, order, scratch.keyBuffer, scratch.orderBuffer);
+
+    edgeTwin.assign(edgeOrigin.size(), NONE);
+    bool open = false, nonPlanar = false;
+
+    // origens de pares twin com a mesma direcao (faces com orientacao inconsistente)
+    std::vector<uint32_t> sameDirectionOrigins;
+
+    // cada sequencia de chaves iguais eh uma aresta geometrica
+    size_t begin = 0;
+    while (begin < keys.size()) {
+        size_t end = begin + 1;
+        while (end < keys.size() && keys[end] == keys[begin]) {
+            end++;
         }
+        matchEdgeGroup(&order[begin], end - begin, open, nonPlanar, sameDirectionOrigins);
+        begin = end;
+    }
+
+    if (hasRepeatedOrigin(sameDirectionOrigins)) {
+        nonPlanar = true;
     }
-    
-    // conecta as half-edges gemeas (twins) usando o mapeamento criado
-    for (auto& [key, edgePair] : edgeMap) {
-        if (edgePair.first && edgePair.second) {
-            edgePair.first->twin = edgePair.second;
-            edgePair.second->twin = edgePair.first;
+    openEdges = open;
+    nonPlanarEdges = nonPlanar;
+}
+
+template <typename Coord>
+void BasicDCEL<Coord>::matchEdgeGroup(const uint32_t* group, size_t count, bool& open,
+                                      bool& nonPlanar, std::vector<uint32_t>& sameDirectionOrigins) {
+    Stats::tick(Stats::EDGE_LOOKUPS, count);
+
+    // pareamento: a ultima half-edge criada de cada direcao, com a
+    // mais recente em first (mesma regra do antigo mapa de arestas)
+    uint32_t first = group[0];
+    uint32_t second = NONE;
+    for (size_t i = 1; i < count; i++) {
+        uint32_t he = group[i];
+        if (edgeOrigin[first] == edgeOrigin[he]) {
+            second = he;
+        } else {
+            second = first;
+            first = he;
         }
     }
-    
-    return true;
+
+    if (second != NONE) {
+        edgeTwin[first] = second;
+        edgeTwin[second] = first;
+    }
+
+    // aresta de fronteira, ou tocada por mais de duas faces (count), deixa
+    // half-edges sem twin; twins devem pertencer a faces diferentes
+    if (count != 2 || edgeFace[first] == edgeFace[second]) {
+        open = true;
+    }
+
+    // em subdivisao planar valida cada aresta deve tocar exatamente 2 faces
+    if (count > 2) {
+        nonPlanar = true;
+    }
+
+    if (count == 2 && edgeOrigin[first] == edgeOrigin[second]) {
+        sameDirectionOrigins.push_back(edgeOrigin[first]);
+    }
 }
 
-void DCEL::linkHalfEdgeChains() {
-    // conecta as half-edges de cada face em uma cadeia circular ordenada
-    for (const auto& face : faces) {
-        HalfEdge* start = face->outerComponent;
-        if (!start) continue;
-        
-        HalfEdge* current = start;
-        // previne loops infinitos em casos mal formados
-        std::vector<HalfEdge*> faceEdges;
-        
+template <typename Coord>
+bool BasicDCEL<Coord>::hasRepeatedOrigin(std::vector<uint32_t>& sameDirectionOrigins) {
+    // twins na mesma direcao tem destino igual a origem, entao a contagem por
+    // (origem, destino) junta todos os que saem do mesmo vertice; dois ou mais
+    // pares no mesmo vertice dao mais de 2 faces para a "aresta" degenerada
+    std::sort(sameDirectionOrigins.begin(), sameDirectionOrigins.end());
+    return std::adjacent_find(sameDirectionOrigins.begin(), sameDirectionOrigins.end()) !=
+           sameDirectionOrigins.end();
+}
+
+template <typename Coord>
+void BasicDCEL<Coord>::linkHalfEdgeChains() {
+    if (constructionThreads != 1) {
+        linkHalfEdgeChainsParallel();
+        return;
+    }
+    Stats::Timer timer(Stats::LINK_CHAINS);
+
+    // half-edges de uma face sao criadas em sequencia, entao cada face ocupa
+    // um intervalo contiguo; para cada vertice guardamos a primeira half-edge
+    // da face atual que sai dele (mesma escolha da antiga busca linear)
+    std::vector<uint32_t> originStamp(vertexX.size(), NONE);
+    std::vector<uint32_t> firstFromOrigin(vertexX.size(), NONE);
+    std::vector<bool> visited(edgeOrigin.size(), false);
+
+    size_t begin = 0;
+    while (begin < edgeOrigin.size()) {
+        uint32_t face = edgeFace[begin];
+
+        size_t end = begin;
+        for (; end < edgeOrigin.size() && edgeFace[end] == face; end++) {
+            uint32_t originIdx = edgeOrigin[end];
+            if (originStamp[originIdx] != face) {
+                originStamp[originIdx] = face;
+                firstFromOrigin[originIdx] = (uint32_t)end;
+            }
+        }
+
+        // conecta as half-edges da face em uma cadeia circular ordenada
+        uint32_t start = faceEdge[face];
+        uint32_t current = start;
+
         do {
-            faceEdges.push_back(current);
-            
-            // busca a proxima half-edge que comeca onde a atual termina
-            HalfEdge* next = nullptr;
-            Vertex* targetVertex = current->destination();
-            
-            for (const auto& he : halfEdges) {
-                if (he->incidentFace == face.get() && 
-                    he->origin == targetVertex) {
-                    next = he.get();
-                    break;
-                }
+            visited[current] = true;
+
+            // proxima half-edge: a que comeca onde a atual termina, na mesma face
+            uint32_t next = NONE;
+            uint32_t targetVertex = destination(current);
+            if (targetVertex != NONE && originStamp[targetVertex] == face) {
+                next = firstFromOrigin[targetVertex];
             }
-            
+
             // estabelece conexoes bidirecionais entre half-edges consecutivas
-            current->next = next;
-            if (next) {
-                next->prev = current;
+            edgeNext[current] = next;
+            if (next != NONE) {
+                edgePrev[next] = current;
             }
             current = next;
-            
-            // continua ate fechar o ciclo ou detectar problema
-        } while (current && current != start && 
-                 faceEdges.size() < halfEdges.size());
+
+            // para ao fechar o ciclo, em cadeia quebrada ou ao revisitar uma
+            // half-edge (ciclo que nao passa por start em casos mal formados)
+        } while (current != NONE && current != start && !visited[current]);
+
+        begin = end;
     }
 }
 
-bool DCEL::isValidDCEL() const {
+template <typename Coord>
+DCELBase::Verdict BasicDCEL<Coord>::validate() const {
+    // estrutura ja validada (por exemplo, carregada de um snapshot validado)
+    if (validated) {
+        return Verdict::VALID;
+    }
+
     if (hasOpenEdges()) {
-        printf("aberta\n");
-        return false;
+        return Verdict::OPEN;
     }
-    
+
     if (isNonPlanarSubdivision()) {
-        printf("não subdivisão planar\n");
-        return false;
+        return Verdict::NON_PLANAR;
     }
-    
+
     if (hasIntersectingFaces()) {
-        printf("superposta\n");
+        return Verdict::OVERLAPPING;
+    }
+
+    validated = true;
+    return Verdict::VALID;
+}
+
+const char* DCELBase::verdictName(Verdict verdict) {
+    switch (verdict) {
+        case Verdict::OPEN:        return "aberta";
+        case Verdict::NON_PLANAR:  return "não subdivisão planar";
+        case Verdict::OVERLAPPING: return "superposta";
+        default:                   return "valida";
+    }
+}
+
+template <typename Coord>
+bool BasicDCEL<Coord>::isValidDCEL() const {
+    Verdict verdict = validate();
+    if (verdict != Verdict::VALID) {
+        printf("%s\n", verdictName(verdict));
         return false;
     }
-    
     return true;
 }
 
-bool DCEL::hasOpenEdges() const {
-    // verifica se a malha esta fechada checando propriedades das half-edges
-    for (const auto& he : halfEdges) {
-        // half-edge sem twin indica aresta de fronteira (malha aberta)
-        if (!he->twin) {
-            return true;
-        }
-        
-        // relacao twin deve ser simetrica (twin do twin eh a propria half-edge)
-        if (he->twin->twin != he.get()) {
-            return true;
-        }
-        
-        // twins devem pertencer a faces diferentes (propriedade fundamental do dcel)
-        if (he->incidentFace == he->twin->incidentFace) {
-            return true;
-        }
+template <typename Coord>
+bool BasicDCEL<Coord>::hasOpenEdges() const {
+    Stats::Timer timer(Stats::OPEN_EDGES);
+    // calculado junto com os twins em matchTwins
+    return openEdges;
+}
+
+template <typename Coord>
+bool BasicDCEL<Coord>::isNonPlanarSubdivision() const {
+    Stats::Timer timer(Stats::NON_PLANAR);
+    // calculado junto com os twins em matchTwins
+    return nonPlanarEdges;
+}
+
+template <typename Coord>
+bool BasicDCEL<Coord>::hasIntersectingFaces() const {
+    Stats::Timer timer(Stats::INTERSECTIONS);
+
+    if (intersectionMethod == IntersectionMethod::QUADRATIC) {
+        return hasIntersectingFacesQuadratic();
     }
-    return false;
+    return hasIntersectingFacesSweep();
 }
 
-bool DCEL::isNonPlanarSubdivision() const {
-    // conta quantas faces cada aresta geometrica toca para validar planaridade
-    std::map<EdgeKey, int> edgeFaceCount;
-    
-    for (const auto& he : halfEdges) {
-        if (!he->origin || !he->destination()) continue;
-        
-        // normaliza aresta para chave unica independente da direcao
-        EdgeKey key(he->origin->index, he->destination()->index);
-        edgeFaceCount[key]++;
-    }
-    
-    // em subdivisao planar valida cada aresta deve tocar exatamente 2 faces
-    for (const auto& [key, count] : edgeFaceCount) {
-        if (count != 2) {
-            return true;
-        }
+template <typename Coord>
+bool BasicDCEL<Coord>::hasIntersectingFacesSweep() const {
+    // cada aresta geometrica entra uma unica vez (a half-edge de menor indice do par);
+    // twins nunca se testam e os demais casos de vertice compartilhado sao
+    // descartados pelo proprio Sweep, como no teste par a par
+    // half-edges sem twin nao tem destino e ja foram rejeitadas por hasOpenEdges
+    std::vector<Sweep::Segment<Coord>> segments;
+    segments.reserve(edgeOrigin.size() / 2);
+
+    for (uint32_t he = 0; he < edgeOrigin.size(); he++) {
+        uint32_t twin = edgeTwin[he];
+        if (twin == NONE || twin < he) continue;
+
+        segments.emplace_back(segmentStart(he), segmentEnd(he),
+                              (int)edgeOrigin[he], (int)edgeOrigin[twin]);
     }
-    return false;
+
+    return Sweep::hasIntersection(segments);
 }
 
-bool DCEL::hasIntersectingFaces() const {
-    for (size_t i = 0; i < halfEdges.size(); i++) {
-        for (size_t j = i + 1; j < halfEdges.size(); j++) {
-            const auto& he1 = halfEdges[i];
-            const auto& he2 = halfEdges[j];
-            
+template <typename Coord>
+bool BasicDCEL<Coord>::hasIntersectingFacesQuadratic() const {
+    // destinos e coordenadas de cada half-edge lidos uma vez; os candidatos de cada
+    // he1 sao testados em lote (Geometry::segmentsIntersectBatch)
+    size_t count = edgeOrigin.size();
+    std::vector<uint32_t> dest(count);
+    std::vector<Coord> startX(count), startY(count), endX(count), endY(count);
+    for (uint32_t he = 0; he < count; he++) {
+        dest[he] = destination(he);
+        Point start = segmentStart(he), end = segmentEnd(he);
+        startX[he] = start.x;
+        startY[he] = start.y;
+        endX[he] = end.x;
+        endY[he] = end.y;
+    }
+
+    Geometry::SegmentPairs<Coord> pairs;
+    pairs.resize(count);
+    std::vector<uint64_t> hits;
+
+    for (uint32_t he1 = 0; he1 < count; he1++) {
+        uint32_t origin1 = edgeOrigin[he1];
+        uint32_t dest1 = dest[he1];
+        size_t candidates = 0;
+
+        for (uint32_t he2 = he1 + 1; he2 < count; he2++) {
+            uint32_t origin2 = edgeOrigin[he2];
+            uint32_t dest2 = dest[he2];
+
             // pula half-edges gemeas (mesma aresta em direcoes opostas, exemplo: a->b e b->a)
-            if (he1->twin == he2.get() || he2->twin == he1.get()) {
+            if (edgeTwin[he1] == he2 || edgeTwin[he2] == he1) {
                 continue;
             }
-                        
+
             // caso 1: ambas half-edges comecam no mesmo vertice
             // exemplo: he1: a->b, he2: a->c (mesmo vertice)
-            if (he1->origin == he2->origin) continue;
-            
+            if (origin1 == origin2) continue;
+
             // caso 2: inicio de he1 eh o fim de he2
             // exemplo: he1: a->b, he2: c->a
-            if (he1->origin == he2->destination()) continue;
-            
+            if (origin1 == dest2) continue;
+
             // caso 3: fim de he1 eh o inicio de he2
             // exemplo: he1: a->b, he2: b->c
-            if (he1->destination() == he2->origin) continue;
-            
+            if (dest1 == origin2) continue;
+
             // caso 4: ambas half-edges terminam no mesmo vertice
             // exemplo: he1: a->b, he2: c->b
-            if (he1->destination() == he2->destination()) continue;
-            
-            if (Geometry::segmentsIntersect(
-                    he1->getSegmentStart(), he1->getSegmentEnd(),
-                    he2->getSegmentStart(), he2->getSegmentEnd())) {
+            if (dest1 == dest2) continue;
+
+            pairs.p1x[candidates] = startX[he1];
+            pairs.p1y[candidates] = startY[he1];
+            pairs.q1x[candidates] = endX[he1];
+            pairs.q1y[candidates] = endY[he1];
+            pairs.p2x[candidates] = startX[he2];
+            pairs.p2y[candidates] = startY[he2];
+            pairs.q2x[candidates] = endX[he2];
+            pairs.q2y[candidates] = endY[he2];
+            candidates++;
+        }
+
+        Stats::tick(Stats::SEGMENT_PAIRS, candidates);
+        Geometry::segmentsIntersectBatch(pairs, candidates, hits);
+        for (uint64_t word : hits) {
+            if (word != 0) {
                 return true;
             }
         }
@@ -282,27 +526,96 @@ bool DCEL::hasIntersectingFaces() const {
     return false;
 }
 
-void DCEL::printDCEL() const {
-    printf("%zu %zu %zu\n", getVertexCount(), getEdgeCount(), getFaceCount());
-    
-    // converte indices internos 0-based para saida 1-based
-    for (const auto& vertex : vertices) {
-        printf("%d %d %d\n", 
-               vertex->position.x, 
-               vertex->position.y,
-               vertex->incidentEdge ? internalToOutput(vertex->incidentEdge->index) : 1);
-    }
-    
-    for (const auto& face : faces) {
-        printf("%d\n", face->outerComponent ? internalToOutput(face->outerComponent->index) : 1);
-    }
-    
-    for (const auto& he : halfEdges) {
-        printf("%d %d %d %d %d\n",
-               he->origin ? internalToOutput(he->origin->index) : 1,
-               he->twin ? internalToOutput(he->twin->index) : 1,
-               he->incidentFace ? internalToOutput(he->incidentFace->index) : 1,
-               he->next ? internalToOutput(he->next->index) : 1,
-               he->prev ? internalToOutput(he->prev->index) : 1);
-    }
-} 
\ No newline at end of file
+template <typename Coord>
+void BasicDCEL<Coord>::printDCEL() const {
+    // descarrega o que ja foi escrito com stdio antes de escrever direto no descritor
+    fflush(stdout);
+    printDCEL(STDOUT_FILENO);
+}
+
+template <typename Coord>
+bool BasicDCEL<Coord>::printDCEL(int fd) const {
+    if (!freeFaces.empty()) {
+        fprintf(stderr, "erro: faces vagas apos removeEdge, chame compact() antes\n");
+        return false;
+    }
+    OutputBuffer out(fd);
+
+    out.putNumber(getVertexCount());
+    out.put(' ');
+    out.putNumber(getEdgeCount());
+    out.put(' ');
+    out.putNumber(getFaceCount());
+    out.put('\n');
+
+    // linhas ja com os indices de saida (1-based)
+    auto putVertex = [&](Coord x, Coord y, int edge) {
+        out.putNumber(x);
+        out.put(' ');
+        out.putNumber(y);
+        out.put(' ');
+        out.putNumber(edge);
+        out.put('\n');
+    };
+    auto putHalfEdge = [&](const uint32_t* fields) {
+        for (int k = 0; k < 5; k++) {
+            out.putNumber(fields[k]);
+            out.put(k < 4 ? ' ' : '\n');
+        }
+    };
+    // converte indices internos 0-based para saida 1-based, na numeracao da entrada
+    auto edgeOutput = [&](uint32_t he) { return he != NONE ? internalToOutput(inputHalfEdge(he)) : 1; };
+    auto halfEdgeFields = [&](uint32_t he, uint32_t* fields) {
+        fields[0] = internalToOutput(inputVertex(edgeOrigin[he]));
+        fields[1] = edgeOutput(edgeTwin[he]);
+        fields[2] = internalToOutput(edgeFace[he]);
+        fields[3] = edgeOutput(edgeNext[he]);
+        fields[4] = edgeOutput(edgePrev[he]);
+    };
+
+    if (!isReordered()) {
+        for (uint32_t v = 0; v < vertexX.size(); v++) {
+            putVertex(vertexX[v], vertexY[v], edgeOutput(vertexEdge[v]));
+        }
+    } else {
+        // depois de reorderForLocality a saida segue a ordem da entrada: as linhas
+        // sao espalhadas para a posicao de entrada lendo a estrutura em sequencia,
+        // um acesso fora de ordem por linha em vez de um por campo
+        struct VertexRow { Coord x, y; int edge; };
+        std::vector<VertexRow> rows(vertexX.size());
+        for (uint32_t v = 0; v < vertexX.size(); v++) {
+            rows[vertexSource[v]] = {vertexX[v], vertexY[v], edgeOutput(vertexEdge[v])};
+        }
+        for (const VertexRow& row : rows) {
+            putVertex(row.x, row.y, row.edge);
+        }
+    }
+
+    for (uint32_t f = 0; f < faceEdge.size(); f++) {
+        out.putNumber(edgeOutput(faceEdge[f]));
+        out.put('\n');
+    }
+
+    uint32_t fields[5];
+    if (!isReordered()) {
+        for (uint32_t he = 0; he < edgeOrigin.size(); he++) {
+            halfEdgeFields(he, fields);
+            putHalfEdge(fields);
+        }
+    } else {
+        std::vector<uint32_t> rows(5 * edgeOrigin.size());
+        for (uint32_t he = 0; he < edgeOrigin.size(); he++) {
+            halfEdgeFields(he, &rows[5 * (size_t)edgeSource[he]]);
+        }
+        for (size_t i = 0; i < rows.size(); i += 5) {
+            putHalfEdge(&rows[i]);
+        }
+    }
+
+    return out.flush();
+}
+
+// instancias para cada largura de coordenada (coordinate.h)
+template class BasicDCEL<int16_t>;
+template class BasicDCEL<int32_t>;
+template class BasicDCEL<int64_t>;
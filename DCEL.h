@@ -2,98 +2,283 @@
 #define DCEL_H
 
 #include <vector>
-#include <map>
-#include <memory>
+#include <initializer_list>
 #include <utility>
+#include <cstddef>
+#include <cstdint>
+#include "circulator.h"
+#include "column.h"
+#include "coordinate.h"
+#include "grid.h"
 
-// forward declarations
-struct Vertex;
-struct Face;
-struct HalfEdge;
-
-struct Point {
-    int x, y;
-    
-    Point() : x(0), y(0) {}
-    Point(int x, int y) : x(x), y(y) {}
-    
-    bool operator==(const Point& other) const;
-    bool operator!=(const Point& other) const;
-};
+struct MeshData;
+class MeshParser;
+template <typename Coord> struct BasicDiagnosis;
 
-struct Vertex {
-    Point position;
-    int index;
-    HalfEdge* incidentEdge;
-    
-    Vertex() : index(-1), incidentEdge(nullptr) {}
-    Vertex(const Point& p, int idx) : position(p), index(idx), incidentEdge(nullptr) {}
-};
+template <typename Coord>
+struct BasicPoint {
+    Coord x, y;
+
+    BasicPoint() : x(0), y(0) {}
+    BasicPoint(Coord x, Coord y) : x(x), y(y) {}
 
-struct Face {
-    int index;
-    HalfEdge* outerComponent;
-    
-    Face() : index(-1), outerComponent(nullptr) {}
-    Face(int idx) : index(idx), outerComponent(nullptr) {}
+    bool operator==(const BasicPoint& other) const { return x == other.x && y == other.y; }
+    bool operator!=(const BasicPoint& other) const { return !(*this == other); }
 };
 
-struct HalfEdge {
-    int index;
-    Vertex* origin;
-    HalfEdge* twin;
-    Face* incidentFace;
-    HalfEdge* next;
-    HalfEdge* prev;
-    
-    HalfEdge() : index(-1), origin(nullptr), twin(nullptr), 
-                 incidentFace(nullptr), next(nullptr), prev(nullptr) {}
-    
-    Vertex* destination() const;
-    Point getSegmentStart() const;
-    Point getSegmentEnd() const;
+using Point = BasicPoint<int32_t>;
+
+// tipos comuns a todas as larguras de coordenada
+class DCELBase {
+public:
+    // indice ausente (half-edge sem twin, cadeia quebrada, vertice isolado)
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    // estrategia do teste de superposicao
+    enum class IntersectionMethod {
+        SWEEP,      // linha de varredura sobre arestas unicas, O(n log n)
+        QUADRATIC   // todos os pares de half-edges, O(n^2), para conferencia
+    };
+
+    // resultado da validacao, na ordem em que os criterios sao testados
+    enum class Verdict {
+        VALID,
+        OPEN,         // "aberta"
+        NON_PLANAR,   // "não subdivisão planar"
+        OVERLAPPING   // "superposta"
+    };
+
+    static const char* verdictName(Verdict verdict);
 };
 
-class DCEL {
+// armazenamento em vetores paralelos (structure of arrays) com indices de 32 bits:
+// vertices, faces e half-edges sao identificados pela posicao nos vetores. Coord eh
+// o tipo das coordenadas (int16_t, int32_t ou int64_t, ver coordinate.h); as
+// instancias sao geradas explicitamente nos .cpp
+template <typename Coord>
+class BasicDCEL : public DCELBase {
+public:
+    using Point = BasicPoint<Coord>;
+    using Diagnosis = BasicDiagnosis<Coord>;
+
 private:
-    struct EdgeKey {
-        int from, to;
-        EdgeKey(int f, int t) : from(std::min(f, t)), to(std::max(f, t)) {}
-        bool operator<(const EdgeKey& other) const {
-            return from < other.from || (from == other.from && to < other.to);
-        }
-    };
+    // vertices: coordenadas e uma half-edge que parte do vertice
+    Column<Coord> vertexX;
+    Column<Coord> vertexY;
+    Column<uint32_t> vertexEdge;
+
+    // faces: half-edge do contorno externo
+    Column<uint32_t> faceEdge;
+
+    // half-edges
+    Column<uint32_t> edgeOrigin;
+    Column<uint32_t> edgeTwin;
+    Column<uint32_t> edgeFace;
+    Column<uint32_t> edgeNext;
+    Column<uint32_t> edgePrev;
+
+    // posicao na entrada (0-based) de cada vertice e half-edge depois de
+    // reorderForLocality (reorder.cpp); vazias quando a ordem eh a da entrada
+    Column<uint32_t> vertexSource;
+    Column<uint32_t> edgeSource;
+
+    // vereditos calculados junto com o pareamento de twins
+    bool openEdges = false;
+    bool nonPlanarEdges = false;
+
+    // isValidDCEL ja aprovou a estrutura (tambem restaurado de snapshots)
+    mutable bool validated = false;
+
+    IntersectionMethod intersectionMethod = IntersectionMethod::SWEEP;
 
-    std::vector<std::unique_ptr<Vertex>> vertices;
-    std::vector<std::unique_ptr<Face>> faces;
-    std::vector<std::unique_ptr<HalfEdge>> halfEdges;
-    std::vector<std::vector<int>> faceVertexIndices;
-    std::map<EdgeKey, std::pair<HalfEdge*, HalfEdge*>> edgeMap;
+    // threads da construcao (parallel.cpp); 1 usa o caminho serial
+    unsigned constructionThreads = 1;
+
+    // edicao incremental (edit.cpp): grade com uma entrada por aresta para os
+    // testes locais de superposicao, montada na primeira edicao, e faces
+    // liberadas por removeEdge que ainda nao foram reaproveitadas
+    SegmentGrid edgeGrid;
+    std::vector<uint32_t> freeFaces;
+    std::vector<uint32_t> gridHits;
+
+    // buffers temporarios da construcao serial (chaves das arestas e ordenacao),
+    // guardados entre cargas: uma DCEL reaproveitada, como na validacao em lote
+    // (batch.cpp), limpa os vetores em vez de realoca-los a cada malha
+    struct BuildScratch {
+        std::vector<uint64_t> keys, keyBuffer;
+        std::vector<uint32_t> order, orderBuffer;
+    };
+    BuildScratch scratch;
 
 private:
     // conversao de indices: entrada usa 1-based, interno usa 0-based
     static int inputToInternal(int inputIndex) { return inputIndex - 1; }
-    static int internalToOutput(int internalIndex) { return internalIndex + 1; }
-    
-    bool constructDCEL();
-    bool createHalfEdges();
+    static int internalToOutput(uint32_t internalIndex) { return (int)internalIndex + 1; }
+
+    static bool checkCoordinates(const MeshData& mesh);
+    bool constructDCEL(const MeshData& mesh);
+    bool createHalfEdges(const MeshData& mesh);
+    void addFaceHalfEdges(uint32_t faceIdx, const int* faceVertices, size_t numVertices,
+                          std::vector<uint64_t>& keys);
+    void matchTwins(std::vector<uint64_t>& keys);
+    void matchEdgeGroup(const uint32_t* group, size_t count, bool& open, bool& nonPlanar,
+                        std::vector<uint32_t>& sameDirectionOrigins);
+    static bool hasRepeatedOrigin(std::vector<uint32_t>& sameDirectionOrigins);
+    bool hasRepeatedEdges();
     void linkHalfEdgeChains();
+    // mesmas etapas divididas entre threads, com numeracao identica a serial
+    void createHalfEdgesParallel(const MeshData& mesh, std::vector<uint64_t>& keys);
+    void matchTwinsParallel(std::vector<uint64_t>& keys);
+    void linkHalfEdgeChainsParallel();
     bool hasOpenEdges() const;
     bool isNonPlanarSubdivision() const;
     bool hasIntersectingFaces() const;
+    bool hasIntersectingFacesSweep() const;
+    bool hasIntersectingFacesQuadratic() const;
+
+    // validate() e grade de arestas; depois de reorderForLocality volta a ordem da
+    // entrada, traduzindo as half-edges e o vertice recebidos pela edicao
+    Verdict prepareEdit(std::initializer_list<uint32_t*> halfEdges, uint32_t* vertex = nullptr);
+    void buildEdgeGrid();
+    void resetEditState();
+    bool crossesEdges(uint32_t a, uint32_t b, const Point& pa, const Point& pb);
+    bool hasEdge(uint32_t a, uint32_t b);
+    uint32_t appendHalfEdge(uint32_t originIdx, uint32_t face);
+    void eraseHalfEdge(uint32_t he);
+    void setCycleFace(uint32_t first, uint32_t stop, uint32_t face);
+    uint32_t allocateFace();
+
+    // renumera vertices e half-edges: newVertex[v] e newEdge[he] sao os indices novos
+    void permute(const std::vector<uint32_t>& newVertex, const std::vector<uint32_t>& newEdge);
+    void restoreInputOrder();
+
+    // destino pela ordem da face, sem depender do pareamento de twins
+    uint32_t cycleDestination(uint32_t he) const;
+
+    // indices das colunas de um snapshot dentro das contagens e, com o veredito
+    // gravado, hasClosedLinks (snapshot.cpp)
+    bool checkLinks() const;
+    // ligacoes completas e coerentes entre si, com todo ciclo fechado: condicao
+    // para gravar e aceitar FLAG_VALIDATED; supoe os indices dentro das contagens
+    bool hasClosedLinks() const;
 
 public:
-    DCEL() = default;
-    ~DCEL() = default;
+    BasicDCEL() = default;
+    ~BasicDCEL() = default;
 
-    bool loadFromInput();
+    // le do arquivo indicado ou, sem caminho, da entrada padrao
+    bool loadFromInput(const char* path = nullptr);
+    bool loadFromMesh(const MeshData& mesh);
+    // mesma construcao com memoria limitada (stream.cpp): uma thread le as faces
+    // enquanto a outra cria as half-edges e pareia os twins de forma incremental
+    bool loadFromInputStreaming(const char* path = nullptr);
+    // continua a leitura em fluxo depois de parser.parseHeader(header, nFaces), para
+    // quem precisa ver as coordenadas antes de escolher a largura
+    bool loadFromInputStreaming(MeshParser& parser, MeshData& mesh, int nFaces);
     void printDCEL() const;
+    // mesma saida de printDCEL() escrita no descritor indicado
+    bool printDCEL(int fd) const;
+
+    // snapshot binario da estrutura construida (snapshot.cpp); o carregamento
+    // mapeia o arquivo em memoria e usa as colunas diretamente, sem reconstruir
+    bool saveSnapshot(const char* path) const;
+    bool loadSnapshot(const char* path);
+    // isValidDCEL imprime o veredito quando a malha eh invalida; validate so o devolve
     bool isValidDCEL() const;
+    Verdict validate() const;
+    // todos os defeitos de uma vez, em vez do primeiro veredito (diagnosis.cpp);
+    // tambem funciona em malhas abertas, cujas cadeias nao foram ligadas
+    void diagnose(Diagnosis& diagnosis) const;
+    void setIntersectionMethod(IntersectionMethod method) { intersectionMethod = method; }
+    // threads usadas para criar as half-edges, parear twins e ligar as cadeias
+    // (0 usa todos os nucleos); a numeracao e a saida de printDCEL sao as mesmas
+    // da construcao serial, o padrao, com qualquer numero de threads
+    void setConstructionThreads(unsigned threads) { constructionThreads = threads; }
 
-    size_t getVertexCount() const { return vertices.size(); }
-    size_t getFaceCount() const { return faces.size(); }
-    size_t getHalfEdgeCount() const { return halfEdges.size(); }
-    size_t getEdgeCount() const { return halfEdges.size() / 2; }
+    // edicao incremental (edit.cpp) de uma DCEL valida; a primeira edicao chama
+    // validate() e monta a grade de arestas em O(n), as seguintes conferem so as
+    // arestas criadas ou movidas contra os criterios de validate(), com custo
+    // proporcional a mudanca. se algum criterio falhar, o veredito eh devolvido e
+    // a estrutura fica como estava. as posicoes novas devem estar no intervalo
+    // exato de Coord (fitsCoordinate), como as da entrada
+    // novo vertice (o ultimo) na posicao indicada, dividindo a aresta de he em duas;
+    // as duas half-edges novas ficam no fim
+    Verdict splitEdge(uint32_t he, const Point& position);
+    // liga as origens de from e to, half-edges da mesma face, dividindo a face em
+    // duas; a parte com menos half-edges recebe a face nova
+    Verdict insertDiagonal(uint32_t from, uint32_t to);
+    // remove a aresta de he e junta as duas faces; as duas ultimas half-edges
+    // ocupam os indices liberados e a face absorvida fica vaga (outerComponent NONE)
+    // ate que outra insercao a reaproveite ou compact() seja chamado
+    Verdict removeEdge(uint32_t he);
+    Verdict moveVertex(uint32_t v, const Point& position);
+    // renumera as faces para fechar as vagas (printDCEL e saveSnapshot recusam
+    // estruturas com faces vagas)
+    void compact();
+
+    // renumera os vertices pela curva de Hilbert e agrupa as half-edges de cada
+    // face, com as faces na ordem dos seus vertices, para que os saltos por
+    // origin, twin e next caiam perto na memoria; as faces nao mudam. printDCEL
+    // continua escrevendo a numeracao da entrada, saveSnapshot grava a permutacao
+    // junto e a primeira edicao volta a ordem da entrada. sem efeito se a DCEL ja
+    // estiver reordenada
+    void reorderForLocality();
+    bool isReordered() const { return !vertexSource.empty(); }
+    // indice na entrada (0-based) do vertice ou half-edge interno
+    uint32_t inputVertex(uint32_t v) const { return vertexSource.empty() ? v : vertexSource[v]; }
+    uint32_t inputHalfEdge(uint32_t he) const { return edgeSource.empty() ? he : edgeSource[he]; }
+
+    size_t getVertexCount() const { return vertexX.size(); }
+    size_t getFaceCount() const { return faceEdge.size(); }
+    size_t getHalfEdgeCount() const { return edgeOrigin.size(); }
+    size_t getEdgeCount() const { return edgeOrigin.size() / 2; }
+
+    // consulta somente leitura, usada por draw e outros clientes da biblioteca
+    // (indices internos 0-based, NONE quando ausente)
+    Point vertexPosition(uint32_t v) const { return Point(vertexX[v], vertexY[v]); }
+    uint32_t incidentEdge(uint32_t v) const { return vertexEdge[v]; }
+    uint32_t outerComponent(uint32_t f) const { return faceEdge[f]; }
+    uint32_t origin(uint32_t he) const { return edgeOrigin[he]; }
+    uint32_t twin(uint32_t he) const { return edgeTwin[he]; }
+    uint32_t incidentFace(uint32_t he) const { return edgeFace[he]; }
+    uint32_t next(uint32_t he) const { return edgeNext[he]; }
+    uint32_t prev(uint32_t he) const { return edgePrev[he]; }
+
+    // destino da half-edge eh a origem do twin
+    uint32_t destination(uint32_t he) const {
+        return edgeTwin[he] != NONE ? edgeOrigin[edgeTwin[he]] : NONE;
+    }
+    Point segmentStart(uint32_t he) const { return vertexPosition(edgeOrigin[he]); }
+    Point segmentEnd(uint32_t he) const {
+        uint32_t dest = destination(he);
+        return dest != NONE ? vertexPosition(dest) : Point();
+    }
+
+    // percursos sem alocacao (circulator.h), para range-for e algoritmos da
+    // biblioteca padrao: half-edges da face a partir de outerComponent, half-edges
+    // que saem do vertice a partir de incidentEdge (ate a borda, se houver) e
+    // vertices da face; uma ligacao ausente encerra o percurso
+    CirculatorRange<CirculatorKind::FACE_EDGES> faceEdges(uint32_t f) const {
+        return circulate<CirculatorKind::FACE_EDGES>(faceEdge[f]);
+    }
+    CirculatorRange<CirculatorKind::VERTEX_EDGES> vertexEdges(uint32_t v) const {
+        return circulate<CirculatorKind::VERTEX_EDGES>(vertexEdge[v]);
+    }
+    CirculatorRange<CirculatorKind::FACE_VERTICES> faceVertices(uint32_t f) const {
+        return circulate<CirculatorKind::FACE_VERTICES>(faceEdge[f]);
+    }
+
+private:
+    template <CirculatorKind KIND>
+    CirculatorRange<KIND> circulate(uint32_t start) const {
+        return CirculatorRange<KIND>(Circulator<KIND>(edgeNext.data(), edgeTwin.data(),
+                                                      edgeOrigin.data(), start, edgeOrigin.size()));
+    }
 };
 
-#endif // DCEL_H 
\ No newline at end of file
+using DCEL = BasicDCEL<int32_t>;
+
+// largura das coordenadas gravada no snapshot, para escolher a instancia antes de carrega-lo
+bool readSnapshotWidth(const char* path, CoordinateWidth& width);
+
+#endif // DCEL_H
\ No newline at end of file
@@ -0,0 +1,247 @@
+#include "batch.h"
+#include "DCEL.h"
+#include "parser.h"
+#include "writer.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <dirent.h>
+#include <sys/stat.h>
+
+namespace {
+    // uma DCEL de cada largura por thread, reaproveitadas entre as malhas
+    struct Worker {
+        BasicDCEL<int16_t> dcel16;
+        BasicDCEL<int32_t> dcel32;
+        BasicDCEL<int64_t> dcel64;
+        MeshData mesh;
+    };
+
+    template <typename Coord>
+    std::string validateWith(BasicDCEL<Coord>& dcel, const MeshData& mesh) {
+        if (!dcel.loadFromMesh(mesh)) {
+            return "erro: falha ao carregar entrada";
+        }
+        return DCELBase::verdictName(dcel.validate());
+    }
+
+    // veredito da malha na menor largura exata, como no malha sem lote
+    std::string validateMesh(Worker& worker, const MeshData& mesh) {
+        int64_t low = 0, high = 0;
+        mesh.coordinateRange(low, high);
+        CoordinateWidth width;
+        if (!narrowestWidth(low, high, width)) {
+            return "erro: coordenadas fora do intervalo suportado (-2^62, 2^62)";
+        }
+        switch (width) {
+            case CoordinateWidth::BITS16: return validateWith(worker.dcel16, mesh);
+            case CoordinateWidth::BITS32: return validateWith(worker.dcel32, mesh);
+            default:                      return validateWith(worker.dcel64, mesh);
+        }
+    }
+
+    unsigned workerCount(unsigned threads, size_t jobs) {
+        if (threads == 0) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        return (unsigned)std::max<size_t>(1, std::min<size_t>(threads, jobs));
+    }
+
+    // linhas na ordem da entrada: cada thread entrega a sua e o prefixo completo
+    // eh escrito na hora; so ficam guardadas as que chegaram adiantadas
+    class OrderedOutput {
+    private:
+        std::mutex lock;
+        std::map<size_t, std::string> early;
+        size_t next = 0;
+        OutputBuffer& out;
+        Batch::Summary& summary;
+
+    public:
+        OrderedOutput(OutputBuffer& out, Batch::Summary& summary) : out(out), summary(summary) {}
+
+        void publish(size_t index, const std::string& name, const std::string& verdict) {
+            std::string line = name + '\t' + verdict + '\n';
+            std::lock_guard<std::mutex> guard(lock);
+            summary.meshes++;
+            if (verdict.compare(0, 5, "erro:") == 0) {
+                summary.failed++;
+            }
+            early.emplace(index, std::move(line));
+            while (!early.empty() && early.begin()->first == next) {
+                out.put(early.begin()->second.c_str());
+                early.erase(early.begin());
+                next++;
+            }
+        }
+    };
+
+    // arquivos regulares do diretorio, em ordem de nome
+    bool listDirectory(const char* path, std::vector<std::string>& paths) {
+        DIR* dir = opendir(path);
+        if (!dir) {
+            fprintf(stderr, "erro: %s: %s\n", path, strerror(errno));
+            return false;
+        }
+        std::string prefix = std::string(path) + '/';
+        while (dirent* entry = readdir(dir)) {
+            std::string file = prefix + entry->d_name;
+            struct stat info;
+            if (entry->d_name[0] != '.' && stat(file.c_str(), &info) == 0 && S_ISREG(info.st_mode)) {
+                paths.push_back(file);
+            }
+        }
+        closedir(dir);
+        std::sort(paths.begin(), paths.end());
+        return true;
+    }
+
+    // um caminho por linha, ignorando linhas vazias
+    bool readList(const char* path, std::vector<std::string>& paths) {
+        FILE* file = fopen(path, "r");
+        if (!file) {
+            fprintf(stderr, "erro: %s: %s\n", path, strerror(errno));
+            return false;
+        }
+        char* line = nullptr;
+        size_t capacity = 0;
+        ssize_t length;
+        while ((length = getline(&line, &capacity, file)) >= 0) {
+            while (length > 0 && (line[length - 1] == '\n' || line[length - 1] == '\r')) {
+                line[--length] = '\0';
+            }
+            if (length > 0) {
+                paths.emplace_back(line, (size_t)length);
+            }
+        }
+        free(line);
+        fclose(file);
+        return true;
+    }
+}
+
+namespace Batch {
+    bool validateFiles(const char* source, unsigned threads, OutputBuffer& out, Summary& summary) {
+        std::vector<std::string> paths;
+        struct stat info;
+        bool listed = stat(source, &info) == 0 && S_ISDIR(info.st_mode) ? listDirectory(source, paths)
+                                                                         : readList(source, paths);
+        if (!listed) {
+            return false;
+        }
+
+        OrderedOutput output(out, summary);
+        std::atomic<size_t> nextPath{0};
+        auto work = [&](Worker& worker) {
+            for (size_t i; (i = nextPath.fetch_add(1)) < paths.size();) {
+                MeshParser parser;
+                bool parsed = parser.openFile(paths[i].c_str()) && parser.parse(worker.mesh);
+                output.publish(i, paths[i], parsed ? validateMesh(worker, worker.mesh)
+                                                   : "erro: " + parser.getError());
+            }
+        };
+
+        // a thread que chama tambem valida
+        std::vector<Worker> workers(workerCount(threads, paths.size()));
+        std::vector<std::thread> pool;
+        for (size_t t = 1; t < workers.size(); t++) {
+            pool.emplace_back(work, std::ref(workers[t]));
+        }
+        work(workers[0]);
+        for (std::thread& thread : pool) {
+            thread.join();
+        }
+        return true;
+    }
+
+    bool validateStream(const char* path, unsigned threads, OutputBuffer& out, Summary& summary) {
+        MeshParser parser;
+        if (!(path ? parser.openFile(path) : parser.openStdin())) {
+            fprintf(stderr, "erro: %s\n", parser.getError().c_str());
+            return false;
+        }
+
+        // malhas lidas e ainda nao validadas; duas por thread deixam a leitura
+        // adiantada sem guardar o fluxo inteiro
+        struct Slot {
+            size_t index = 0;
+            MeshData mesh;
+        };
+        std::vector<Worker> workers(workerCount(threads, SIZE_MAX));
+        std::vector<Slot> slots(2 * workers.size());
+        std::vector<Slot*> idle;
+        for (Slot& slot : slots) {
+            idle.push_back(&slot);
+        }
+        std::deque<Slot*> queue;
+        bool finished = false;
+        std::mutex lock;
+        std::condition_variable ready, freed;
+
+        OrderedOutput output(out, summary);
+        auto work = [&](Worker& worker) {
+            for (;;) {
+                Slot* slot;
+                {
+                    std::unique_lock<std::mutex> guard(lock);
+                    ready.wait(guard, [&] { return !queue.empty() || finished; });
+                    if (queue.empty()) {
+                        return;
+                    }
+                    slot = queue.front();
+                    queue.pop_front();
+                }
+                output.publish(slot->index, std::to_string(slot->index + 1),
+                               validateMesh(worker, slot->mesh));
+                {
+                    std::lock_guard<std::mutex> guard(lock);
+                    idle.push_back(slot);
+                }
+                freed.notify_one();
+            }
+        };
+
+        std::vector<std::thread> pool;
+        for (Worker& worker : workers) {
+            pool.emplace_back(work, std::ref(worker));
+        }
+        for (size_t index = 0; !parser.atEnd(); index++) {
+            Slot* slot;
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                freed.wait(guard, [&] { return !idle.empty(); });
+                slot = idle.back();
+                idle.pop_back();
+            }
+            if (!parser.parse(slot->mesh)) {
+                output.publish(index, std::to_string(index + 1), "erro: " + parser.getError());
+                break;
+            }
+            slot->index = index;
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                queue.push_back(slot);
+            }
+            ready.notify_one();
+            parser.releaseConsumed();
+        }
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            finished = true;
+        }
+        ready.notify_all();
+        for (std::thread& thread : pool) {
+            thread.join();
+        }
+        return true;
+    }
+}
@@ -0,0 +1,32 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <cstddef>
+
+class OutputBuffer;
+
+// validacao em lote (batch.cpp): muitas malhas pequenas ou medias validadas por
+// um grupo de threads em um unico processo. cada thread guarda uma DCEL de cada
+// largura de coordenada e a reaproveita entre as malhas (loadFromMesh limpa os
+// vetores sem liberar a memoria), entao o custo por malha fica na leitura e na
+// validacao, sem criar processo nem realocar a estrutura. a saida tem uma linha
+// por malha, na ordem da entrada: o nome e o veredito de validate() separados
+// por tabulacao, ou "erro: ..." quando a malha nao pode ser lida ou carregada
+namespace Batch {
+    struct Summary {
+        size_t meshes = 0;
+        size_t failed = 0;    // malhas com erro de leitura ou carga
+    };
+
+    // malhas de um diretorio (arquivos regulares, em ordem de nome) ou de uma
+    // lista com um caminho por linha; threads 0 usa todos os nucleos. false (com a
+    // mensagem no stderr) se a origem nao puder ser lida
+    bool validateFiles(const char* source, unsigned threads, OutputBuffer& out, Summary& summary);
+
+    // malhas concatenadas no arquivo (ou na entrada padrao, sem caminho), numeradas
+    // a partir de 1: a thread que chama le em sequencia e as demais validam. um erro
+    // de leitura encerra o fluxo, ja que a malha seguinte nao pode ser localizada
+    bool validateStream(const char* path, unsigned threads, OutputBuffer& out, Summary& summary);
+}
+
+#endif
@@ -0,0 +1,517 @@
+#include "DCEL.h"
+#include "parser.h"
+#include "writer.h"
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+// medicao de desempenho com malhas sinteticas: cada familia gera malhas validas
+// ou deliberadamente abertas, nao planares ou superpostas, com 10^2 a 10^7
+// arestas, e cada fase (leitura, construcao, validacao, impressao) eh cronometrada
+// separadamente. a saida eh CSV (padrao) ou JSON; --compare aponta as fases que
+// ficaram mais lentas que em um CSV anterior
+
+namespace {
+    const char* FAMILIES[] = {"grid", "convex", "thin", "degenerate"};
+    const char* VARIANTS[] = {"valid", "open", "nonplanar", "overlap"};
+    const DCEL::Verdict EXPECTED[] = {
+        DCEL::Verdict::VALID, DCEL::Verdict::OPEN,
+        DCEL::Verdict::NON_PLANAR, DCEL::Verdict::OVERLAPPING
+    };
+
+    // o teste par a par so roda ate este numero de arestas
+    const size_t QUADRATIC_LIMIT = 5000;
+
+    // fases cronometradas, na ordem das colunas da saida
+    const char* PHASES[] = {"parse", "build", "validate", "quadratic", "print", "stream"};
+    const int PHASE_COUNT = 6;
+
+    struct Generated {
+        MeshData mesh;
+        std::vector<int> face;  // face em construcao (1-based)
+
+        int addVertex(int64_t x, int64_t y) {
+            mesh.vertexX.push_back(x);
+            mesh.vertexY.push_back(y);
+            return (int)mesh.vertexX.size();
+        }
+
+        void closeFace() {
+            if (mesh.faceStart.empty()) {
+                mesh.faceStart.push_back(0);
+            }
+            mesh.faceVertices.insert(mesh.faceVertices.end(), face.begin(), face.end());
+            mesh.faceStart.push_back(mesh.faceVertices.size());
+            face.clear();
+        }
+    };
+
+    // vertice (i, j) de uma grade com columns + 1 vertices por linha
+    int gridIndex(int i, int j, int columns) {
+        return j * (columns + 1) + i + 1;
+    }
+
+    // face externa de uma grade columns x rows, no sentido horario
+    void addGridBoundary(Generated& g, int columns, int rows) {
+        for (int j = 0; j < rows; j++) g.face.push_back(gridIndex(0, j, columns));
+        for (int i = 0; i < columns; i++) g.face.push_back(gridIndex(i, rows, columns));
+        for (int j = rows; j > 0; j--) g.face.push_back(gridIndex(columns, j, columns));
+        for (int i = columns; i > 0; i--) g.face.push_back(gridIndex(i, 0, columns));
+        g.closeFace();
+    }
+
+    // quadrados iguais: ~2 w^2 arestas
+    void generateGrid(Generated& g, size_t edges) {
+        int side = std::max(1, (int)std::sqrt(edges / 2.0));
+        for (int j = 0; j <= side; j++) {
+            for (int i = 0; i <= side; i++) {
+                g.addVertex(i * 16, j * 16);
+            }
+        }
+        for (int j = 0; j < side; j++) {
+            for (int i = 0; i < side; i++) {
+                g.face = {gridIndex(i, j, side), gridIndex(i + 1, j, side),
+                          gridIndex(i + 1, j + 1, side), gridIndex(i, j + 1, side)};
+                g.closeFace();
+            }
+        }
+        addGridBoundary(g, side, side);
+    }
+
+    // grade com vertices internos deslocados ao acaso e celulas sorteadas entre
+    // quadrilatero e dois triangulos (em qualquer diagonal); as faces continuam
+    // convexas porque o deslocamento eh menor que um quarto da celula
+    void generateConvex(Generated& g, size_t edges) {
+        std::mt19937 random(12345);
+        int side = std::max(1, (int)std::sqrt(edges / 2.5));
+        for (int j = 0; j <= side; j++) {
+            for (int i = 0; i <= side; i++) {
+                bool inner = i > 0 && j > 0 && i < side && j < side;
+                int dx = inner ? (int)(random() % 7) - 3 : 0;
+                int dy = inner ? (int)(random() % 7) - 3 : 0;
+                g.addVertex(i * 16 + dx, j * 16 + dy);
+            }
+        }
+        for (int j = 0; j < side; j++) {
+            for (int i = 0; i < side; i++) {
+                int a = gridIndex(i, j, side), b = gridIndex(i + 1, j, side);
+                int c = gridIndex(i + 1, j + 1, side), d = gridIndex(i, j + 1, side);
+                switch (random() % 3) {
+                    case 0:
+                        g.face = {a, b, c, d};
+                        g.closeFace();
+                        break;
+                    case 1:
+                        g.face = {a, b, c};
+                        g.closeFace();
+                        g.face = {a, c, d};
+                        g.closeFace();
+                        break;
+                    default:
+                        g.face = {a, b, d};
+                        g.closeFace();
+                        g.face = {b, c, d};
+                        g.closeFace();
+                        break;
+                }
+            }
+        }
+        addGridBoundary(g, side, side);
+    }
+
+    // faixas verticais de largura 4 e altura 4 * rows, cada uma uma face com
+    // 2 * rows + 2 vertices
+    void generateThin(Generated& g, size_t edges) {
+        int rows = std::max(2, (int)(4 * std::sqrt((double)edges)));
+        int columns = std::max(1, (int)(edges / rows));
+        for (int j = 0; j <= rows; j++) {
+            for (int i = 0; i <= columns; i++) {
+                g.addVertex(i * 4, j * 4);
+            }
+        }
+        for (int i = 0; i < columns; i++) {
+            g.face.push_back(gridIndex(i, 0, columns));
+            for (int j = 0; j <= rows; j++) g.face.push_back(gridIndex(i + 1, j, columns));
+            for (int j = rows; j > 0; j--) g.face.push_back(gridIndex(i, j, columns));
+            g.closeFace();
+        }
+        addGridBoundary(g, columns, rows);
+    }
+
+    // faixa de triangulos achatados: base em y = 0 e topo em y = 1, com largura
+    // de ate 2^20, entao quase todo teste de orientacao fica perto do colinear
+    // e a base inteira eh colinear
+    void generateDegenerate(Generated& g, size_t edges) {
+        int count = std::max(2, (int)(edges / 4));
+        int width = (int)std::max(4LL, std::min(1LL << 20, 2000000000LL / count));
+        for (int i = 0; i <= count; i++) {
+            g.addVertex(i * width, 0);
+        }
+        for (int i = 0; i < count; i++) {
+            g.addVertex(i * width + width / 2, 1);
+        }
+        auto base = [](int i) { return i + 1; };
+        auto top = [count](int i) { return count + 2 + i; };
+        for (int i = 0; i < count; i++) {
+            g.face = {base(i), base(i + 1), top(i)};
+            g.closeFace();
+            if (i + 1 < count) {
+                g.face = {top(i), base(i + 1), top(i + 1)};
+                g.closeFace();
+            }
+        }
+        g.face.push_back(base(0));
+        for (int i = 0; i < count; i++) g.face.push_back(top(i));
+        for (int i = count; i > 0; i--) g.face.push_back(base(i));
+        g.closeFace();
+    }
+
+    // aplica o defeito pedido a uma malha valida
+    void applyVariant(Generated& g, int variant) {
+        MeshData& mesh = g.mesh;
+        int64_t maxX = mesh.vertexX[0], minY = mesh.vertexY[0];
+        for (size_t v = 0; v < mesh.vertexX.size(); v++) {
+            maxX = std::max(maxX, mesh.vertexX[v]);
+            minY = std::min(minY, mesh.vertexY[v]);
+        }
+
+        if (variant == 1) {
+            // sem a primeira face, suas arestas ficam sem twin
+            size_t removed = mesh.faceStart[1];
+            mesh.faceVertices.erase(mesh.faceVertices.begin(), mesh.faceVertices.begin() + removed);
+            mesh.faceStart.erase(mesh.faceStart.begin());
+            for (size_t& start : mesh.faceStart) {
+                start -= removed;
+            }
+        } else if (variant == 2) {
+            // dois triangulos duplicados com um vertice em comum, a direita da
+            // malha: twins na mesma direcao saindo duas vezes do mesmo vertice
+            int p = g.addVertex(maxX + 16, minY);
+            int q = g.addVertex(maxX + 20, minY);
+            int r = g.addVertex(maxX + 16, minY + 4);
+            int s = g.addVertex(maxX + 20, minY - 4);
+            int t = g.addVertex(maxX + 16, minY - 4);
+            for (int copy = 0; copy < 2; copy++) {
+                g.face = {p, q, r};
+                g.closeFace();
+                g.face = {p, s, t};
+                g.closeFace();
+            }
+        } else if (variant == 3) {
+            // triangulo fechado em volta de um vertice da malha, cruzando as
+            // arestas que saem dele
+            size_t center = mesh.vertexX.size() / 2;
+            int64_t x = mesh.vertexX[center], y = mesh.vertexY[center];
+            int a = g.addVertex(x - 1, y - 1);
+            int b = g.addVertex(x + 1, y - 1);
+            int c = g.addVertex(x, y + 1);
+            g.face = {a, b, c};
+            g.closeFace();
+            g.face = {a, c, b};
+            g.closeFace();
+        }
+    }
+
+    bool generate(const std::string& family, int variant, size_t edges, Generated& g) {
+        if (family == "grid") generateGrid(g, edges);
+        else if (family == "convex") generateConvex(g, edges);
+        else if (family == "thin") generateThin(g, edges);
+        else if (family == "degenerate") generateDegenerate(g, edges);
+        else return false;
+        applyVariant(g, variant);
+        return true;
+    }
+
+    bool writeMesh(const MeshData& mesh, int fd) {
+        OutputBuffer out(fd);
+        out.putNumber(mesh.getVertexCount());
+        out.put(' ');
+        out.putNumber(mesh.getFaceCount());
+        out.put('\n');
+        for (size_t v = 0; v < mesh.getVertexCount(); v++) {
+            out.putNumber(mesh.vertexX[v]);
+            out.put(' ');
+            out.putNumber(mesh.vertexY[v]);
+            out.put('\n');
+        }
+        for (size_t f = 0; f < mesh.getFaceCount(); f++) {
+            for (size_t i = mesh.faceStart[f]; i < mesh.faceStart[f + 1]; i++) {
+                if (i > mesh.faceStart[f]) out.put(' ');
+                out.putNumber(mesh.faceVertices[i]);
+            }
+            out.put('\n');
+        }
+        return out.flush();
+    }
+
+    int findIndex(const char* const* names, int count, const char* name) {
+        for (int i = 0; i < count; i++) {
+            if (strcmp(names[i], name) == 0) return i;
+        }
+        return -1;
+    }
+
+    double elapsedMs(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    struct Result {
+        std::string family, variant;
+        size_t edges = 0, vertices = 0, faces = 0;
+        const char* verdict = "";
+        double ms[PHASE_COUNT];  // negativo quando a fase nao rodou
+    };
+
+    // mede uma malha ja gravada em path; cada fase fica com o menor tempo
+    bool measure(const char* path, Result& result, int repeat, int expected) {
+        std::fill(result.ms, result.ms + PHASE_COUNT, -1.0);
+        auto keep = [&](int phase, double ms) {
+            if (result.ms[phase] < 0 || ms < result.ms[phase]) result.ms[phase] = ms;
+        };
+
+        int devNull = open("/dev/null", O_WRONLY);
+        for (int run = 0; run < repeat; run++) {
+            auto start = std::chrono::steady_clock::now();
+            MeshParser parser;
+            MeshData mesh;
+            if (!parser.openFile(path) || !parser.parse(mesh)) {
+                fprintf(stderr, "erro: %s\n", parser.getError().c_str());
+                close(devNull);
+                return false;
+            }
+            keep(0, elapsedMs(start));
+
+            DCEL dcel;
+            start = std::chrono::steady_clock::now();
+            dcel.loadFromMesh(mesh);
+            keep(1, elapsedMs(start));
+
+            start = std::chrono::steady_clock::now();
+            DCEL::Verdict verdict = dcel.validate();
+            keep(2, elapsedMs(start));
+            result.verdict = DCEL::verdictName(verdict);
+            result.edges = dcel.getEdgeCount();
+            result.vertices = dcel.getVertexCount();
+            result.faces = dcel.getFaceCount();
+            if (verdict != EXPECTED[expected]) {
+                fprintf(stderr, "erro: %s/%s com %zu arestas: esperado \"%s\", obtido \"%s\"\n",
+                        result.family.c_str(), result.variant.c_str(), result.edges,
+                        DCEL::verdictName(EXPECTED[expected]), result.verdict);
+                close(devNull);
+                return false;
+            }
+
+            if (result.edges <= QUADRATIC_LIMIT) {
+                DCEL quadratic;
+                quadratic.loadFromMesh(mesh);
+                quadratic.setIntersectionMethod(DCEL::IntersectionMethod::QUADRATIC);
+                start = std::chrono::steady_clock::now();
+                quadratic.validate();
+                keep(3, elapsedMs(start));
+            }
+
+            if (verdict == DCEL::Verdict::VALID) {
+                start = std::chrono::steady_clock::now();
+                dcel.printDCEL(devNull);
+                keep(4, elapsedMs(start));
+            }
+
+            DCEL streamed;
+            start = std::chrono::steady_clock::now();
+            streamed.loadFromInputStreaming(path);
+            keep(5, elapsedMs(start));
+        }
+        close(devNull);
+        return true;
+    }
+
+    void printCsvHeader() {
+        printf("family,variant,edges,vertices,faces,verdict");
+        for (const char* phase : PHASES) printf(",%s_ms", phase);
+        printf("\n");
+    }
+
+    void printCsv(const Result& r) {
+        printf("%s,%s,%zu,%zu,%zu,%s", r.family.c_str(), r.variant.c_str(),
+               r.edges, r.vertices, r.faces, r.verdict);
+        for (double ms : r.ms) {
+            if (ms < 0) printf(",");
+            else printf(",%.3f", ms);
+        }
+        printf("\n");
+        fflush(stdout);
+    }
+
+    void printJson(const std::vector<Result>& results) {
+        printf("[\n");
+        for (size_t i = 0; i < results.size(); i++) {
+            const Result& r = results[i];
+            printf("  {\"family\": \"%s\", \"variant\": \"%s\", \"edges\": %zu, \"vertices\": %zu, "
+                   "\"faces\": %zu, \"verdict\": \"%s\"",
+                   r.family.c_str(), r.variant.c_str(), r.edges, r.vertices, r.faces, r.verdict);
+            for (int p = 0; p < PHASE_COUNT; p++) {
+                if (r.ms[p] < 0) printf(", \"%s_ms\": null", PHASES[p]);
+                else printf(", \"%s_ms\": %.3f", PHASES[p], r.ms[p]);
+            }
+            printf("}%s\n", i + 1 < results.size() ? "," : "");
+        }
+        printf("]\n");
+    }
+
+    // chave "family,variant,edges" -> tempos de um CSV anterior
+    typedef std::map<std::string, std::vector<double>> Baseline;
+
+    bool readBaseline(const char* path, Baseline& baseline) {
+        FILE* file = fopen(path, "r");
+        if (!file) {
+            fprintf(stderr, "erro: %s: %s\n", path, strerror(errno));
+            return false;
+        }
+        char line[1024];
+        while (fgets(line, sizeof(line), file)) {
+            std::vector<std::string> fields(1);
+            for (char* c = line; *c && *c != '\n'; c++) {
+                if (*c == ',') fields.emplace_back();
+                else fields.back() += *c;
+            }
+            if (fields.size() != 6 + PHASE_COUNT || fields[0] == "family") continue;
+            std::vector<double> ms(PHASE_COUNT, -1.0);
+            for (int p = 0; p < PHASE_COUNT; p++) {
+                if (!fields[6 + p].empty()) ms[p] = atof(fields[6 + p].c_str());
+            }
+            baseline[fields[0] + "," + fields[1] + "," + fields[2]] = ms;
+        }
+        fclose(file);
+        return true;
+    }
+
+    // aponta no stderr as fases mais de 25% mais lentas (ignorando tempos < 1 ms)
+    int reportRegressions(const Result& r, const Baseline& baseline) {
+        auto found = baseline.find(r.family + "," + r.variant + "," + std::to_string(r.edges));
+        if (found == baseline.end()) return 0;
+        int regressions = 0;
+        for (int p = 0; p < PHASE_COUNT; p++) {
+            double before = found->second[p];
+            if (before >= 1.0 && r.ms[p] > 1.25 * before) {
+                fprintf(stderr, "regressao: %s/%s %zu arestas, %s: %.3f ms -> %.3f ms (%.2fx)\n",
+                        r.family.c_str(), r.variant.c_str(), r.edges, PHASES[p],
+                        before, r.ms[p], r.ms[p] / before);
+                regressions++;
+            }
+        }
+        return regressions;
+    }
+
+    void usage() {
+        fprintf(stderr,
+                "uso: benchmark [--json] [--min-edges N] [--max-edges N] [--family F]\n"
+                "                 [--variant V] [--repeat N] [--compare anterior.csv]\n"
+                "     benchmark --generate FAMILIA VARIANTE ARESTAS > malha.txt\n"
+                "familias: grid convex thin degenerate; variantes: valid open nonplanar overlap\n");
+    }
+}
+
+int main(int argc, char* argv[]) {
+    bool json = false;
+    size_t minEdges = 100, maxEdges = 1000000;
+    int repeat = 1;
+    const char* onlyFamily = nullptr;
+    const char* onlyVariant = nullptr;
+    const char* comparePath = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--generate") == 0 && i + 3 < argc) {
+            // so grava a malha na saida padrao
+            int variant = findIndex(VARIANTS, 4, argv[i + 2]);
+            Generated g;
+            if (variant < 0 || !generate(argv[i + 1], variant, strtoull(argv[i + 3], nullptr, 10), g)) {
+                usage();
+                return 1;
+            }
+            return writeMesh(g.mesh, STDOUT_FILENO) ? 0 : 1;
+        } else if (strcmp(argv[i], "--json") == 0) {
+            json = true;
+        } else if (strcmp(argv[i], "--min-edges") == 0 && i + 1 < argc) {
+            minEdges = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--max-edges") == 0 && i + 1 < argc) {
+            maxEdges = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--family") == 0 && i + 1 < argc) {
+            onlyFamily = argv[++i];
+        } else if (strcmp(argv[i], "--variant") == 0 && i + 1 < argc) {
+            onlyVariant = argv[++i];
+        } else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--compare") == 0 && i + 1 < argc) {
+            comparePath = argv[++i];
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    Baseline baseline;
+    if (comparePath && !readBaseline(comparePath, baseline)) {
+        return 1;
+    }
+
+    char path[] = "/tmp/dcel-bench-XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        fprintf(stderr, "erro: %s: %s\n", path, strerror(errno));
+        return 1;
+    }
+    close(fd);
+
+    std::vector<Result> results;
+    int regressions = 0;
+    bool ok = true;
+    if (!json) printCsvHeader();
+
+    for (size_t edges = minEdges; ok && edges <= maxEdges; edges *= 10) {
+        for (const char* family : FAMILIES) {
+            if (onlyFamily && strcmp(family, onlyFamily) != 0) continue;
+            for (int variant = 0; ok && variant < 4; variant++) {
+                if (onlyVariant && strcmp(VARIANTS[variant], onlyVariant) != 0) continue;
+
+                Generated g;
+                generate(family, variant, edges, g);
+                fd = open(path, O_WRONLY | O_TRUNC);
+                ok = fd >= 0 && writeMesh(g.mesh, fd);
+                if (fd >= 0) close(fd);
+                g = Generated();  // libera a malha antes de medir
+                if (!ok) {
+                    fprintf(stderr, "erro: %s: falha ao gravar malha\n", path);
+                    break;
+                }
+
+                Result result;
+                result.family = family;
+                result.variant = VARIANTS[variant];
+                if (!measure(path, result, repeat, variant)) {
+                    ok = false;
+                    break;
+                }
+                regressions += reportRegressions(result, baseline);
+
+                if (json) results.push_back(result);
+                else printCsv(result);
+            }
+        }
+    }
+    unlink(path);
+
+    if (json) printJson(results);
+    if (comparePath) {
+        fprintf(stderr, "%d fase(s) mais lenta(s) que em %s\n", regressions, comparePath);
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,501 @@
+#include "dual.h"
+#include "geometry.h"
+#include "locator.h"
+#include "overlay.h"
+#include "parser.h"
+#include "sweep.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+// conferencias de make check: comparam caminhos otimizados com a versao de
+// referencia, ou resultados com os esperados, sobre entradas sorteadas (semente
+// fixa) ou fixas e abortam na primeira diferenca, com a entrada no stderr
+
+namespace {
+    // segmentsIntersectBatch (AVX2 quando disponivel) contra segmentsIntersect par
+    // a par. os sorteios cobrem o caso geral com coordenadas ate o limite da
+    // largura, os extremos (-LIMIT + 1 e LIMIT - 1, onde as diferencas e produtos
+    // das lanes sao maiores), uma grade pequena com muitos pontos colineares e
+    // extremos repetidos (lanes que caem na versao escalar) e segmentos sobre uma
+    // mesma reta. a quantidade nao eh multipla de 8 para cobrir a sobra escalar
+    template <typename Coord>
+    void checkBatchParity(const char* name, std::mt19937_64& random) {
+        using Point = BasicPoint<Coord>;
+        const int64_t high = CoordinateTraits<Coord>::LIMIT - 1;
+        const size_t PAIRS = 200003;
+
+        auto uniform = [&](int64_t low, int64_t top) {
+            return (Coord)std::uniform_int_distribution<int64_t>(low, top)(random);
+        };
+        auto extreme = [&]() {
+            switch (random() % 4) {
+                case 0:  return (Coord)-high;
+                case 1:  return (Coord)high;
+                case 2:  return (Coord)(random() % 2 ? high - 1 : -high + 1);
+                default: return uniform(-high, high);
+            }
+        };
+        // ponto da reta a + t * d, mantendo a coordenada dentro do intervalo
+        auto onLine = [&](Point a, Coord dx, Coord dy) {
+            int64_t t = uniform(-4, 4);
+            auto clamp = [&](int64_t v) { return (Coord)std::max(-high, std::min(high, v)); };
+            return Point(clamp(a.x + t * dx), clamp(a.y + t * dy));
+        };
+
+        Geometry::SegmentPairs<Coord> pairs;
+        for (size_t i = 0; i < PAIRS; i++) {
+            Point p[4];
+            switch (i % 4) {
+                case 0:
+                    for (Point& point : p) point = Point(uniform(-high, high), uniform(-high, high));
+                    break;
+                case 1:
+                    for (Point& point : p) point = Point(extreme(), extreme());
+                    break;
+                case 2:
+                    for (Point& point : p) point = Point(uniform(-3, 3), uniform(-3, 3));
+                    break;
+                default: {
+                    Point a(uniform(-high / 8, high / 8), uniform(-high / 8, high / 8));
+                    Coord dx = uniform(-high / 64, high / 64), dy = uniform(-high / 64, high / 64);
+                    for (Point& point : p) point = onLine(a, dx, dy);
+                    break;
+                }
+            }
+            pairs.add(p[0], p[1], p[2], p[3]);
+        }
+
+        // o lote inteiro e um prefixo, para conferir tambem o count menor que o tamanho
+        std::vector<uint64_t> hits;
+        for (size_t count : {PAIRS, PAIRS - 5}) {
+            Geometry::segmentsIntersectBatch(pairs, count, hits);
+            for (size_t i = 0; i < hits.size() * 64; i++) {
+                bool batch = (hits[i / 64] >> (i % 64)) & 1;
+                bool scalar = i < count && Geometry::segmentsIntersect(
+                    Point(pairs.p1x[i], pairs.p1y[i]), Point(pairs.q1x[i], pairs.q1y[i]),
+                    Point(pairs.p2x[i], pairs.p2y[i]), Point(pairs.q2x[i], pairs.q2y[i]));
+                if (batch != scalar && i >= count) {
+                    fprintf(stderr, "erro: %s: bit %zu ligado alem dos %zu pares\n", name, i, count);
+                    abort();
+                }
+                if (batch != scalar) {
+                    fprintf(stderr, "erro: %s: par %zu de %zu: lote %d, escalar %d: "
+                            "(%lld %lld)-(%lld %lld) x (%lld %lld)-(%lld %lld)\n",
+                            name, i, count, batch, scalar,
+                            (long long)pairs.p1x[i], (long long)pairs.p1y[i],
+                            (long long)pairs.q1x[i], (long long)pairs.q1y[i],
+                            (long long)pairs.p2x[i], (long long)pairs.p2y[i],
+                            (long long)pairs.q2x[i], (long long)pairs.q2y[i]);
+                    abort();
+                }
+            }
+        }
+        printf("ok: segmentsIntersectBatch %s (%zu pares)\n", name, PAIRS);
+    }
+
+    // malha de um poligono simples anti-horario: a face 0 eh o interior e a face
+    // 1 o contorno externo, no sentido horario como no formato de entrada
+    MeshData polygonMesh(const std::vector<int64_t>& coordinates) {
+        MeshData mesh;
+        int n = (int)coordinates.size() / 2;
+        for (int i = 0; i < n; i++) {
+            mesh.vertexX.push_back(coordinates[2 * i]);
+            mesh.vertexY.push_back(coordinates[2 * i + 1]);
+        }
+        mesh.faceStart.push_back(0);
+        for (int i = 1; i <= n; i++) {
+            mesh.faceVertices.push_back(i);
+        }
+        mesh.faceStart.push_back(mesh.faceVertices.size());
+        for (int i = n; i >= 1; i--) {
+            mesh.faceVertices.push_back(i);
+        }
+        mesh.faceStart.push_back(mesh.faceVertices.size());
+        return mesh;
+    }
+
+    // faces do resultado como "faceA faceB: x,y x,y ...", cada ciclo a partir do
+    // menor vertice e a lista ordenada, para nao depender da numeracao
+    std::vector<std::string> overlayFaces(const DCEL& result, const MapOverlay& overlay) {
+        std::vector<std::string> faces;
+        for (uint32_t f = 0; f < result.getFaceCount(); f++) {
+            std::vector<Point> cycle;
+            for (uint32_t v : result.faceVertices(f)) {
+                cycle.push_back(result.vertexPosition(v));
+            }
+            std::rotate(cycle.begin(), std::min_element(cycle.begin(), cycle.end(), [](Point p, Point q) {
+                return p.x != q.x ? p.x < q.x : p.y < q.y;
+            }), cycle.end());
+            std::string face = std::to_string(overlay.faceOfA(f)) + " " + std::to_string(overlay.faceOfB(f)) + ":";
+            for (Point p : cycle) {
+                face += " " + std::to_string(p.x) + "," + std::to_string(p.y);
+            }
+            faces.push_back(face);
+        }
+        std::sort(faces.begin(), faces.end());
+        return faces;
+    }
+
+    // sobreposicao de dois poligonos fixos contra as faces esperadas (ja ordenadas)
+    void checkOverlayCase(const char* name, const std::vector<int64_t>& a, const std::vector<int64_t>& b,
+                          const std::vector<std::string>& expected) {
+        DCEL first, second, result;
+        MapOverlay overlay;
+        if (!first.loadFromMesh(polygonMesh(a)) || !second.loadFromMesh(polygonMesh(b)) ||
+            !overlay.build(first, second, result)) {
+            fprintf(stderr, "erro: sobreposicao %s: build falhou\n", name);
+            abort();
+        }
+        std::vector<std::string> faces = overlayFaces(result, overlay);
+        if (faces != expected) {
+            fprintf(stderr, "erro: sobreposicao %s: faces diferentes\n", name);
+            for (const std::string& face : faces) {
+                fprintf(stderr, "  obtida: %s\n", face.c_str());
+            }
+            for (const std::string& face : expected) {
+                fprintf(stderr, "  esperada: %s\n", face.c_str());
+            }
+            abort();
+        }
+        printf("ok: sobreposicao %s (%zu faces)\n", name, faces.size());
+    }
+
+    // triangulos sorteados numa grade pequena, onde os cruzamentos caem fora dos
+    // pontos inteiros com frequencia: build precisa devolver um resultado valido
+    void checkOverlayRandom(int64_t range, std::mt19937_64& random) {
+        const int CASES = 2000;
+        auto triangle = [&]() {
+            for (;;) {
+                std::vector<int64_t> t(6);
+                for (int64_t& c : t) {
+                    c = std::uniform_int_distribution<int64_t>(0, range)(random);
+                }
+                int64_t area = (t[2] - t[0]) * (t[5] - t[1]) - (t[3] - t[1]) * (t[4] - t[0]);
+                if (area < 0) {
+                    std::swap(t[2], t[4]);
+                    std::swap(t[3], t[5]);
+                }
+                if (area != 0) {
+                    return t;
+                }
+            }
+        };
+        size_t rounded = 0;
+        for (int i = 0; i < CASES; i++) {
+            std::vector<int64_t> a = triangle(), b = triangle();
+            DCEL first, second, result;
+            MapOverlay overlay;
+            first.loadFromMesh(polygonMesh(a));
+            second.loadFromMesh(polygonMesh(b));
+            if (!overlay.build(first, second, result)) {
+                fprintf(stderr, "erro: sobreposicao sorteada %d: (%lld %lld) (%lld %lld) (%lld %lld) x "
+                        "(%lld %lld) (%lld %lld) (%lld %lld)\n", i,
+                        (long long)a[0], (long long)a[1], (long long)a[2], (long long)a[3],
+                        (long long)a[4], (long long)a[5], (long long)b[0], (long long)b[1],
+                        (long long)b[2], (long long)b[3], (long long)b[4], (long long)b[5]);
+                abort();
+            }
+            rounded += overlay.getRoundedCount() > 0;
+        }
+        printf("ok: sobreposicao sorteada em [0, %lld] (%d pares, %zu com arredondamento)\n",
+               (long long)range, CASES, rounded);
+    }
+
+    void require(bool condition, const char* what) {
+        if (!condition) {
+            fprintf(stderr, "erro: %s\n", what);
+            abort();
+        }
+    }
+
+    // grade n x n de quadrados de lado step com canto em (0, 0): a face j * n + i
+    // eh o quadrado de canto (i, j) * step, anti-horario, e a ultima o contorno
+    // externo
+    MeshData gridMesh(int n, int step = 1) {
+        MeshData mesh;
+        auto vertex = [&](int i, int j) { return 1 + j * (n + 1) + i; };
+        for (int j = 0; j <= n; j++) {
+            for (int i = 0; i <= n; i++) {
+                mesh.vertexX.push_back(i * step);
+                mesh.vertexY.push_back(j * step);
+            }
+        }
+        mesh.faceStart.push_back(0);
+        for (int j = 0; j < n; j++) {
+            for (int i = 0; i < n; i++) {
+                for (int corner : {vertex(i, j), vertex(i + 1, j), vertex(i + 1, j + 1), vertex(i, j + 1)}) {
+                    mesh.faceVertices.push_back(corner);
+                }
+                mesh.faceStart.push_back(mesh.faceVertices.size());
+            }
+        }
+        // contorno no sentido horario: sobe pela esquerda, vai pelo topo, desce
+        // pela direita e volta pela base
+        for (int j = 0; j < n; j++) mesh.faceVertices.push_back(vertex(0, j));
+        for (int i = 0; i < n; i++) mesh.faceVertices.push_back(vertex(i, n));
+        for (int j = n; j > 0; j--) mesh.faceVertices.push_back(vertex(n, j));
+        for (int i = n; i > 0; i--) mesh.faceVertices.push_back(vertex(i, 0));
+        mesh.faceStart.push_back(mesh.faceVertices.size());
+        return mesh;
+    }
+
+    // quadrado dividido pela diagonal com o segundo triangulo e o contorno na
+    // orientacao trocada: cada aresta ainda tem duas faces e os pares de twins na
+    // mesma direcao saem de vertices diferentes, entao validate() aceita, mas as
+    // cadeias next ficam com NONE e em forma de rho (laco sem voltar ao inicio)
+    MeshData flippedMesh() {
+        MeshData mesh;
+        mesh.vertexX = {0, 4, 4, 0};
+        mesh.vertexY = {0, 0, 4, 4};
+        mesh.faceStart = {0, 3, 6, 10};
+        mesh.faceVertices = {1, 2, 3, 1, 4, 3, 1, 4, 3, 2};
+        return mesh;
+    }
+
+    // percursos de circulator.h: tamanho das faces e grau dos vertices numa grade
+    // e termino numa cadeia que nao volta ao inicio
+    void checkCirculators() {
+        const int n = 3;
+        DCEL grid;
+        require(grid.loadFromMesh(gridMesh(n)), "circulador: carga da grade");
+        for (uint32_t f = 0; f < grid.getFaceCount(); f++) {
+            size_t size = std::distance(grid.faceEdges(f).begin(), grid.faceEdges(f).end());
+            size_t corners = std::distance(grid.faceVertices(f).begin(), grid.faceVertices(f).end());
+            size_t expected = f + 1 < grid.getFaceCount() ? 4 : 4 * n;
+            require(size == expected && corners == expected, "circulador: tamanho de face");
+        }
+        for (uint32_t v = 0; v < grid.getVertexCount(); v++) {
+            Point p = grid.vertexPosition(v);
+            size_t degree = std::distance(grid.vertexEdges(v).begin(), grid.vertexEdges(v).end());
+            size_t expected = 2 + (p.x > 0 && p.x < n) + (p.y > 0 && p.y < n);
+            require(degree == expected, "circulador: grau de vertice");
+            for (uint32_t he : grid.vertexEdges(v)) {
+                require(grid.origin(he) == v, "circulador: half-edge fora do vertice");
+            }
+        }
+
+        DCEL flipped;
+        require(flipped.loadFromMesh(flippedMesh()) && flipped.validate() == DCEL::Verdict::VALID,
+                "circulador: carga da malha com twins na mesma direcao");
+        for (uint32_t f = 0; f < flipped.getFaceCount(); f++) {
+            size_t size = std::distance(flipped.faceEdges(f).begin(), flipped.faceEdges(f).end());
+            require(size <= flipped.getHalfEdgeCount(), "circulador: percurso passou do limite");
+        }
+        printf("ok: circuladores (grade %dx%d e cadeia em rho)\n", n, n);
+    }
+
+    // grafo dual da grade 2 x 2 (faces 0 a 3 e a externa, 4) em CSR, com uma e
+    // varias threads, e a recusa de uma malha cujas cadeias nao fecham
+    void checkDualGraph() {
+        DCEL grid;
+        require(grid.loadFromMesh(gridMesh(2)), "dual: carga da grade");
+        const std::vector<uint32_t> offsets = {0, 4, 8, 12, 16, 24};
+        const std::vector<uint32_t> neighbors = {4, 1, 2, 4,  4, 4, 3, 0,  0, 3, 4, 4,  1, 4, 4, 2,
+                                                 0, 2, 2, 3, 3, 1, 1, 0};
+        for (unsigned threads : {1u, 4u}) {
+            DualGraph dual;
+            require(dual.build(grid, threads), "dual: montagem da grade");
+            require(dual.getOffsets() == offsets, "dual: offsets da grade");
+            require(dual.getNeighbors() == neighbors, "dual: vizinhos da grade");
+            for (uint32_t f = 0; f < dual.getFaceCount(); f++) {
+                for (uint32_t i = offsets[f]; i < offsets[f + 1]; i++) {
+                    uint32_t he = dual.getEdges()[i];
+                    require(grid.incidentFace(he) == f && grid.incidentFace(grid.twin(he)) == neighbors[i],
+                            "dual: aresta da entrada");
+                }
+            }
+        }
+
+        DCEL flipped;
+        DualGraph dual;
+        require(flipped.loadFromMesh(flippedMesh()), "dual: carga da malha com twins na mesma direcao");
+        require(!dual.build(flipped) && dual.getFaceCount() == 0 && dual.getEntryCount() == 0,
+                "dual: cadeia que nao fecha aceita");
+        printf("ok: grafo dual (grade 2x2 e cadeia quebrada)\n");
+    }
+
+    // localizacao na grade 3 x 3 de lado 2: centros dos quadrados, pontos sobre
+    // arestas (face de cima, ou da esquerda nas verticais) e fora da malha, um a
+    // um e em lote; e a recusa de uma malha cujas cadeias nao fecham
+    void checkLocator() {
+        const int n = 3;
+        DCEL grid;
+        PointLocator locator;
+        require(grid.loadFromMesh(gridMesh(n, 2)) && locator.build(grid), "localizacao: montagem da grade");
+        std::vector<Point> queries;
+        std::vector<uint32_t> expected;
+        for (int j = 0; j < n; j++) {
+            for (int i = 0; i < n; i++) {
+                queries.push_back(Point(2 * i + 1, 2 * j + 1));
+                expected.push_back(j * n + i + 1);
+            }
+        }
+        const uint32_t outer = n * n + 1;
+        queries.insert(queries.end(), {Point(2, 1), Point(1, 2), Point(5, 4), Point(-1, -1), Point(7, 3),
+                                       Point(3, 0), Point(0, 3)});
+        expected.insert(expected.end(), {1, 4, 9, outer, outer, 2, outer});
+        for (size_t i = 0; i < queries.size(); i++) {
+            if (locator.locate(queries[i]) != expected[i]) {
+                fprintf(stderr, "erro: localizacao: (%d %d) na face %u, esperada %u\n", queries[i].x,
+                        queries[i].y, locator.locate(queries[i]), expected[i]);
+                abort();
+            }
+        }
+        std::vector<uint32_t> faces(queries.size());
+        locator.locateBatch(queries.data(), queries.size(), faces.data(), 4);
+        require(faces == expected, "localizacao: lote diferente das consultas unitarias");
+
+        DCEL flipped;
+        PointLocator broken;
+        require(flipped.loadFromMesh(flippedMesh()) && flipped.validate() == DCEL::Verdict::VALID,
+                "localizacao: carga da malha com twins na mesma direcao");
+        require(!broken.build(flipped), "localizacao: cadeia que nao fecha aceita");
+        printf("ok: localizacao de pontos (grade %dx%d, %zu pontos, e cadeia quebrada)\n", n, n, queries.size());
+    }
+
+    // gravacao e carga do snapshot da grade (veredito gravado) e da malha com
+    // twins na mesma direcao, que validate() aceita com next NONE: as duas voltam
+    // com as mesmas ligacoes e o mesmo veredito, sem o arquivo ser recusado
+    void checkSnapshotRoundTrip() {
+        std::string path = "/tmp/verify-" + std::to_string(getpid()) + ".dcel";
+        for (bool flippedCase : {false, true}) {
+            const char* name = flippedCase ? "twins na mesma direcao" : "grade";
+            DCEL saved, loaded;
+            require(saved.loadFromMesh(flippedCase ? flippedMesh() : gridMesh(3)) &&
+                    saved.validate() == DCEL::Verdict::VALID, name);
+            require(saved.saveSnapshot(path.c_str()), "snapshot: gravacao");
+            bool ok = loaded.loadSnapshot(path.c_str());
+            unlink(path.c_str());
+            if (!ok) {
+                fprintf(stderr, "erro: snapshot: %s recusada na carga\n", name);
+                abort();
+            }
+            require(loaded.getVertexCount() == saved.getVertexCount() &&
+                    loaded.getFaceCount() == saved.getFaceCount() &&
+                    loaded.getHalfEdgeCount() == saved.getHalfEdgeCount(), "snapshot: contagens");
+            for (uint32_t he = 0; he < saved.getHalfEdgeCount(); he++) {
+                require(loaded.origin(he) == saved.origin(he) && loaded.twin(he) == saved.twin(he) &&
+                        loaded.next(he) == saved.next(he) && loaded.prev(he) == saved.prev(he) &&
+                        loaded.incidentFace(he) == saved.incidentFace(he), "snapshot: ligacoes");
+            }
+            require(loaded.validate() == DCEL::Verdict::VALID, "snapshot: veredito");
+        }
+        printf("ok: snapshot (grade e twins na mesma direcao)\n");
+    }
+
+    // varredura contra o teste par a par nas entradas degeneradas, que nao
+    // recorrem mais ao caminho par a par inteiro: grades com uma face invertida e
+    // com um vertice movido (sobre o vizinho, aresta de comprimento zero, ou sobre
+    // a reta da linha, sobreposicao colinear), e grades pequenas sorteadas com
+    // vertices movidos e arestas extras de vertices duplicados nas mesmas coordenadas
+    void checkSweepDegenerate(std::mt19937_64& random) {
+        const int n = 6, step = 2;
+        const int center = 1 + (n / 2) * (n + 1) + n / 2;
+        std::vector<std::pair<const char*, MeshData>> meshes;
+        MeshData mesh = gridMesh(n, step);
+        std::reverse(mesh.faceVertices.begin() + 4 * (n + 1), mesh.faceVertices.begin() + 4 * (n + 2));
+        meshes.emplace_back("face invertida", mesh);
+        for (int64_t dx : {step, step + 1, 2 * step, -step / 2}) {
+            mesh = gridMesh(n, step);
+            mesh.vertexX[center - 1] += dx;
+            meshes.emplace_back("vertice movido", mesh);
+        }
+        for (auto& [name, grid] : meshes) {
+            DCEL sweep, quadratic;
+            quadratic.setIntersectionMethod(DCEL::IntersectionMethod::QUADRATIC);
+            require(sweep.loadFromMesh(grid) && quadratic.loadFromMesh(grid), name);
+            if (sweep.validate() != quadratic.validate()) {
+                fprintf(stderr, "erro: varredura: %s: veredito %d, par a par %d\n", name,
+                        (int)sweep.validate(), (int)quadratic.validate());
+                abort();
+            }
+        }
+
+        using Segment = Sweep::Segment<int32_t>;
+        const int CASES = 20000;
+        size_t intersecting = 0;
+        for (int c = 0; c < CASES; c++) {
+            int k = 1 + random() % 4, spacing = 1 + random() % 3;
+            std::vector<Point> vertices;
+            for (int j = 0; j <= k; j++) {
+                for (int i = 0; i <= k; i++) {
+                    vertices.push_back(Point(i * spacing, j * spacing));
+                }
+            }
+            for (int moved = random() % 3; moved > 0; moved--) {
+                vertices[random() % vertices.size()] = Point((int)(random() % (k * spacing + 3)) - 1,
+                                                             (int)(random() % (k * spacing + 3)) - 1);
+            }
+            std::vector<Segment> segments;
+            auto add = [&](int u, int v) { segments.emplace_back(vertices[u], vertices[v], u, v); };
+            for (int j = 0; j <= k; j++) {
+                for (int i = 0; i <= k; i++) {
+                    int v = j * (k + 1) + i;
+                    if (i < k) add(v, v + 1);
+                    if (j < k) add(v, v + k + 1);
+                }
+            }
+            for (int extra = random() % 3; extra > 0; extra--) {
+                int u = random() % vertices.size(), v = random() % vertices.size();
+                vertices.push_back(vertices[u]);
+                add(vertices.size() - 1, random() % 2 ? u : v);
+            }
+            std::shuffle(segments.begin(), segments.end(), random);
+
+            bool expected = Sweep::hasIntersectionBruteForce(segments);
+            if (Sweep::hasIntersection(segments) != expected) {
+                fprintf(stderr, "erro: varredura sorteada %d: par a par %d:", c, expected);
+                for (const Segment& s : segments) {
+                    fprintf(stderr, " %d(%d %d)-%d(%d %d)", s.u, s.p.x, s.p.y, s.v, s.q.x, s.q.y);
+                }
+                fprintf(stderr, "\n");
+                abort();
+            }
+            intersecting += expected;
+        }
+        printf("ok: varredura degenerada (%zu grades fixas, %d sorteadas, %zu com intersecao)\n",
+               meshes.size(), CASES, intersecting);
+    }
+}
+
+int main() {
+#if defined(__x86_64__) || defined(__i386__)
+    printf("avx2: %s\n", __builtin_cpu_supports("avx2") ? "sim" : "nao (so o laco escalar)");
+#endif
+    std::mt19937_64 random(20240601);
+    checkBatchParity<int16_t>("int16", random);
+    checkBatchParity<int32_t>("int32", random);
+    checkBatchParity<int64_t>("int64", random);
+
+    // cruzamentos inteiros: nada se move
+    checkOverlayCase("quadrados", {0, 0, 4, 0, 4, 4, 0, 4}, {2, 2, 6, 2, 6, 6, 2, 6}, {
+        "0 0: 2,2 4,2 4,4 2,4",
+        "0 1: 0,0 4,0 4,2 2,2 2,4 0,4",
+        "1 0: 2,4 4,4 4,2 6,2 6,6 2,6",
+        "1 1: 0,0 0,4 2,4 2,6 6,6 6,2 4,2 4,0",
+    });
+    // cruzamento em (3/2, 3/2) e arestas que tocam pixels quentes pela quina: a
+    // faixa de b dentro de a fica achatada e o contorno externo estrangula em (2, 2)
+    checkOverlayCase("arredondada", {1, 3, 2, 0, 3, 0, 3, 1, 2, 3}, {0, 3, 3, 0, 3, 1, 1, 3}, {
+        "0 0: 1,3 2,2 2,3",
+        "0 1: 2,0 3,0 3,1 2,2",
+        "1 1: 1,3 2,3 2,2",
+        "1 1: 2,0 2,2 3,1 3,0",
+    });
+    for (int64_t range : {3, 8, 100, 1000}) {
+        checkOverlayRandom(range, random);
+    }
+    checkCirculators();
+    checkDualGraph();
+    checkLocator();
+    checkSnapshotRoundTrip();
+    checkSweepDegenerate(random);
+    return 0;
+}
@@ -0,0 +1,106 @@
+#ifndef CIRCULATOR_H
+#define CIRCULATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#ifdef DCEL_DEBUG
+#include <cstdio>
+#include <cstdlib>
+#endif
+
+// percursos de ciclos da DCEL sem alocacao (circulators), usados por
+// BasicDCEL::faceEdges, vertexEdges e faceVertices. o iterador guarda so a
+// half-edge inicial e a atual e le as colunas next/twin/origin direto, entao
+// serve para range-for e para os algoritmos da biblioteca padrao; qualquer
+// edicao da DCEL invalida os percursos em andamento. um ciclo tem no maximo
+// tantas half-edges quanto a DCEL, entao um percurso que passa disso (cadeia em
+// forma de rho, que entra num laco sem voltar ao inicio) termina ali, e com
+// DCEL_DEBUG aborta com mensagem
+enum class CirculatorKind {
+    FACE_EDGES,     // half-edges de uma face, por next
+    VERTEX_EDGES,   // half-edges que saem de um vertice, por twin e next
+    FACE_VERTICES   // origens das half-edges de uma face
+};
+
+template <CirculatorKind KIND>
+class Circulator {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = uint32_t;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const uint32_t*;
+    using reference = uint32_t;
+
+    // indice ausente, o mesmo de DCELBase::NONE; tambem marca o fim
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    Circulator() = default;
+    Circulator(const uint32_t* next, const uint32_t* twin, const uint32_t* origin,
+               uint32_t start, size_t halfEdges)
+        : next(next), twin(twin), origin(origin), start(start), current(start), limit(halfEdges) {}
+
+    uint32_t operator*() const {
+        return KIND == CirculatorKind::FACE_VERTICES ? origin[current] : current;
+    }
+
+    // o ciclo termina ao voltar ao inicio; no leque de um vertice, tambem numa
+    // half-edge sem twin (borda de malha aberta), e em qualquer percurso depois
+    // de limit half-edges
+    Circulator& operator++() {
+        if (KIND == CirculatorKind::VERTEX_EDGES) {
+            uint32_t back = twin[current];
+            current = back != NONE ? next[back] : NONE;
+        } else {
+            current = next[current];
+        }
+        if (current == start) {
+            current = NONE;
+        }
+        // mais passos que half-edges: o ciclo nao volta ao inicio
+        if (current != NONE && ++steps >= limit) {
+#ifdef DCEL_DEBUG
+            fprintf(stderr, "erro: ciclo sem retorno a half-edge %u\n", start + 1);
+            abort();
+#endif
+            current = NONE;
+        }
+        return *this;
+    }
+
+    Circulator operator++(int) {
+        Circulator previous = *this;
+        ++*this;
+        return previous;
+    }
+
+    bool operator==(const Circulator& other) const { return current == other.current; }
+    bool operator!=(const Circulator& other) const { return current != other.current; }
+
+private:
+    const uint32_t* next = nullptr;
+    const uint32_t* twin = nullptr;
+    const uint32_t* origin = nullptr;
+    uint32_t start = NONE;
+    uint32_t current = NONE;
+    size_t steps = 0;
+    size_t limit = 0;
+};
+
+// par inicio/fim de um percurso
+template <CirculatorKind KIND>
+class CirculatorRange {
+public:
+    using iterator = Circulator<KIND>;
+
+    explicit CirculatorRange(iterator first) : first(first) {}
+
+    iterator begin() const { return first; }
+    iterator end() const { return iterator(); }
+    bool empty() const { return first == iterator(); }
+
+private:
+    iterator first;
+};
+
+#endif
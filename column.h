@@ -0,0 +1,98 @@
+#ifndef COLUMN_H
+#define COLUMN_H
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+// vetor de uma coluna da DCEL: dono da propria memoria (std::vector) ou apontando
+// para memoria externa somente leitura, como um snapshot mapeado com mmap;
+// qualquer escrita em uma coluna externa copia os dados antes (copy-on-write)
+template <typename T>
+class Column {
+private:
+    std::vector<T> owned;
+    const T* external = nullptr;
+    size_t externalSize = 0;
+    std::shared_ptr<const void> keepAlive;  // mantem o mapeamento vivo
+
+    void detach() {
+        if (external) {
+            owned.assign(external, external + externalSize);
+            release();
+        }
+    }
+
+    void release() {
+        external = nullptr;
+        externalSize = 0;
+        keepAlive.reset();
+    }
+
+public:
+    size_t size() const { return external ? externalSize : owned.size(); }
+    bool empty() const { return size() == 0; }
+    const T* data() const { return external ? external : owned.data(); }
+    const T* begin() const { return data(); }
+    const T* end() const { return data() + size(); }
+    bool isExternal() const { return external != nullptr; }
+
+    const T& operator[](size_t i) const { return data()[i]; }
+    T& operator[](size_t i) {
+        detach();
+        return owned[i];
+    }
+
+    // escrita direta, sem a copia condicional de operator[] a cada acesso; usado
+    // pelas threads da construcao paralela, cada uma em posicoes proprias
+    T* mutableData() {
+        detach();
+        return owned.data();
+    }
+
+    void push_back(const T& value) {
+        detach();
+        owned.push_back(value);
+    }
+
+    void pop_back() {
+        detach();
+        owned.pop_back();
+    }
+
+    void reserve(size_t n) {
+        detach();
+        owned.reserve(n);
+    }
+
+    void resize(size_t n, const T& value = T()) {
+        detach();
+        owned.resize(n, value);
+    }
+
+    void assign(size_t n, const T& value) {
+        release();
+        owned.assign(n, value);
+    }
+
+    template <typename Iterator>
+    void assign(Iterator first, Iterator last) {
+        release();
+        owned.assign(first, last);
+    }
+
+    void clear() {
+        release();
+        owned.clear();
+    }
+
+    // passa a ler de memoria externa, liberando a memoria propria
+    void attach(const T* values, size_t n, std::shared_ptr<const void> owner) {
+        std::vector<T>().swap(owned);
+        external = values;
+        externalSize = n;
+        keepAlive = std::move(owner);
+    }
+};
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef COORDINATE_H
+#define COORDINATE_H
+
+#include <cstdint>
+
+// largura das coordenadas, escolhida em tempo de compilacao (BasicDCEL<Coord>):
+// cada tipo tem um intermediario Wide em que o predicado de orientacao eh exato
+// para coordenadas em (-LIMIT, LIMIT), pois as diferencas ocupam bits + 1, os
+// produtos 2 * bits + 2 e o determinante 2 * bits + 3. UnsignedWide acumula
+// somas cujos parciais podem estourar Wide, com o resultado final exato
+__extension__ typedef __int128 int128_t;
+__extension__ typedef unsigned __int128 uint128_t;
+
+template <typename Coord>
+struct CoordinateTraits;
+
+template <>
+struct CoordinateTraits<int16_t> {
+    using Wide = int32_t;
+    using UnsignedWide = uint32_t;
+    static constexpr int64_t LIMIT = int64_t(1) << 14;
+};
+
+template <>
+struct CoordinateTraits<int32_t> {
+    using Wide = int64_t;
+    using UnsignedWide = uint64_t;
+    static constexpr int64_t LIMIT = int64_t(1) << 30;
+};
+
+template <>
+struct CoordinateTraits<int64_t> {
+    using Wide = int128_t;
+    using UnsignedWide = uint128_t;
+    static constexpr int64_t LIMIT = int64_t(1) << 62;
+};
+
+template <typename Coord>
+constexpr bool fitsCoordinate(int64_t value) {
+    return value > -CoordinateTraits<Coord>::LIMIT && value < CoordinateTraits<Coord>::LIMIT;
+}
+
+// instancias disponiveis, da mais estreita para a mais larga
+enum class CoordinateWidth { BITS16, BITS32, BITS64 };
+
+// menor largura exata para coordenadas em [low, high]; false se nenhuma serve
+inline bool narrowestWidth(int64_t low, int64_t high, CoordinateWidth& width) {
+    if (fitsCoordinate<int16_t>(low) && fitsCoordinate<int16_t>(high)) {
+        width = CoordinateWidth::BITS16;
+    } else if (fitsCoordinate<int32_t>(low) && fitsCoordinate<int32_t>(high)) {
+        width = CoordinateWidth::BITS32;
+    } else if (fitsCoordinate<int64_t>(low) && fitsCoordinate<int64_t>(high)) {
+        width = CoordinateWidth::BITS64;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+#endif
@@ -0,0 +1,277 @@
+#include "diagnosis.h"
+#include "geometry.h"
+#include "grid.h"
+#include "stats.h"
+#include "sweep.h"
+#include "writer.h"
+#include <algorithm>
+
+// mesmos criterios de validate(), mas sem parar no primeiro: as arestas sao
+// agrupadas de novo pela chave (min, max) e todas as superposicoes sao
+// enumeradas. o destino de cada half-edge vem da ordem da face, nao do twin,
+// entao malhas abertas ou nao planares tambem tem as superposicoes conferidas
+
+namespace {
+    const char* EDGE_PROBLEM_NAMES[] = {"boundary_edge", "same_face_edge", "overused_edge"};
+
+    const char* verdictCode(DCELBase::Verdict verdict) {
+        switch (verdict) {
+            case DCELBase::Verdict::OPEN:        return "open";
+            case DCELBase::Verdict::NON_PLANAR:  return "non_planar";
+            case DCELBase::Verdict::OVERLAPPING: return "overlapping";
+            default:                         return "valid";
+        }
+    }
+
+    void putIndexList(OutputBuffer& out, const std::vector<uint32_t>& indices) {
+        out.put('[');
+        for (size_t i = 0; i < indices.size(); i++) {
+            if (i > 0) out.put(',');
+            out.putNumber(indices[i] + 1);
+        }
+        out.put(']');
+    }
+
+    template <typename Coord>
+    void putSegment(OutputBuffer& out, const BasicPoint<Coord>& p, const BasicPoint<Coord>& q) {
+        out.put('[');
+        out.putNumber(p.x);
+        out.put(',');
+        out.putNumber(p.y);
+        out.put(',');
+        out.putNumber(q.x);
+        out.put(',');
+        out.putNumber(q.y);
+        out.put(']');
+    }
+
+    // faces das half-edges indicadas (e dos twins, quando pedido), sem repeticao
+    template <typename Coord>
+    std::vector<uint32_t> facesOf(const BasicDCEL<Coord>& dcel,
+                                  const std::vector<uint32_t>& halfEdges, bool withTwins) {
+        std::vector<uint32_t> faces;
+        for (uint32_t he : halfEdges) {
+            faces.push_back(dcel.incidentFace(he));
+            if (withTwins && dcel.twin(he) != DCELBase::NONE) {
+                faces.push_back(dcel.incidentFace(dcel.twin(he)));
+            }
+        }
+        std::sort(faces.begin(), faces.end());
+        faces.erase(std::unique(faces.begin(), faces.end()), faces.end());
+        return faces;
+    }
+}
+
+template <typename Coord>
+uint32_t BasicDCEL<Coord>::cycleDestination(uint32_t he) const {
+    // numa estrutura validada (possivelmente editada) os twins tem direcoes opostas;
+    // fora isso o twin pode ter a mesma direcao, mas a estrutura acabou de ser
+    // construida e as half-edges de cada face estao em sequencia, com a ultima
+    // voltando para a primeira
+    if (validated) {
+        return destination(he);
+    }
+    uint32_t following = he + 1;
+    if (following >= edgeOrigin.size() || edgeFace[following] != edgeFace[he]) {
+        following = faceEdge[edgeFace[he]];
+    }
+    return edgeOrigin[following];
+}
+
+template <typename Coord>
+void BasicDCEL<Coord>::diagnose(Diagnosis& diagnosis) const {
+    Stats::Timer timer(Stats::DIAGNOSE);
+    diagnosis = Diagnosis();
+
+    size_t count = edgeOrigin.size();
+    std::vector<uint32_t> dest(count);
+    std::vector<uint64_t> keys(count);
+    for (uint32_t he = 0; he < count; he++) {
+        dest[he] = cycleDestination(he);
+        uint32_t low = std::min(edgeOrigin[he], dest[he]);
+        uint32_t high = std::max(edgeOrigin[he], dest[he]);
+        keys[he] = ((uint64_t)low << 32) | high;
+    }
+
+    // ordem de criacao dentro de cada aresta, como no pareamento de twins
+    std::vector<uint32_t> order(count);
+    for (uint32_t he = 0; he < count; he++) {
+        order[he] = he;
+    }
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return keys[a] != keys[b] ? keys[a] < keys[b] : a < b;
+    });
+
+    // uma half-edge por aresta geometrica para o teste de superposicao, e os
+    // pares de twins na mesma direcao (origem, half-edges)
+    std::vector<Sweep::Segment<Coord>> segments;
+    std::vector<uint32_t> segmentEdge;
+    std::vector<std::pair<uint32_t, uint32_t>> sameDirection;
+
+    size_t begin = 0;
+    while (begin < count) {
+        size_t end = begin + 1;
+        while (end < count && keys[order[end]] == keys[order[begin]]) {
+            end++;
+        }
+
+        uint32_t he = order[begin];
+        segments.emplace_back(vertexPosition(edgeOrigin[he]), vertexPosition(dest[he]),
+                              (int)edgeOrigin[he], (int)dest[he]);
+        segmentEdge.push_back(he);
+
+        size_t faceCount = end - begin;
+        bool sameFace = faceCount == 2 && edgeFace[order[begin]] == edgeFace[order[begin + 1]];
+        if (faceCount != 2 || sameFace) {
+            typename Diagnosis::EdgeDefect defect;
+            defect.problem = faceCount == 1 ? Diagnosis::EdgeProblem::BOUNDARY
+                           : faceCount == 2 ? Diagnosis::EdgeProblem::SAME_FACE
+                                            : Diagnosis::EdgeProblem::OVERUSED;
+            defect.from = (uint32_t)(keys[he] >> 32);
+            defect.to = (uint32_t)keys[he];
+            defect.halfEdges.assign(order.begin() + begin, order.begin() + end);
+            diagnosis.edges.push_back(std::move(defect));
+        } else if (edgeOrigin[order[begin]] == edgeOrigin[order[begin + 1]]) {
+            sameDirection.emplace_back(edgeOrigin[order[begin]], order[begin]);
+            sameDirection.emplace_back(edgeOrigin[order[begin]], order[begin + 1]);
+        }
+
+        begin = end;
+    }
+
+    // vertices com dois ou mais pares na mesma direcao (hasRepeatedOrigin)
+    std::sort(sameDirection.begin(), sameDirection.end());
+    for (size_t i = 0; i < sameDirection.size();) {
+        size_t j = i;
+        while (j < sameDirection.size() && sameDirection[j].first == sameDirection[i].first) {
+            j++;
+        }
+        if (j - i >= 4) {
+            typename Diagnosis::VertexDefect defect;
+            defect.vertex = sameDirection[i].first;
+            for (size_t k = i; k < j; k++) {
+                defect.halfEdges.push_back(sameDirection[k].second);
+            }
+            diagnosis.vertices.push_back(std::move(defect));
+        }
+        i = j;
+    }
+
+    // a varredura confirma em O(n log n) que nao ha superposicao, o caso comum;
+    // havendo, a grade de segmentos enumera os pares candidatos de cada aresta
+    if (!segments.empty() && Sweep::hasIntersection(segments)) {
+        Coord minX = *std::min_element(vertexX.begin(), vertexX.end());
+        Coord maxX = *std::max_element(vertexX.begin(), vertexX.end());
+        Coord minY = *std::min_element(vertexY.begin(), vertexY.end());
+        Coord maxY = *std::max_element(vertexY.begin(), vertexY.end());
+
+        SegmentGrid grid;
+        grid.build(minX, minY, maxX, maxY, segments.size());
+        for (uint32_t i = 0; i < segments.size(); i++) {
+            const Sweep::Segment<Coord>& s = segments[i];
+            grid.insert(i, s.p.x, s.p.y, s.q.x, s.q.y);
+        }
+
+        std::vector<uint32_t> candidates, tested;
+        Geometry::SegmentPairs<Coord> pairs;
+        std::vector<uint64_t> hits;
+        for (uint32_t i = 0; i < segments.size(); i++) {
+            const Sweep::Segment<Coord>& a = segments[i];
+            grid.query(a.p.x, a.p.y, a.q.x, a.q.y, candidates);
+            tested.clear();
+            pairs.clear();
+            for (uint32_t j : candidates) {
+                if (j <= i) continue;
+                const Sweep::Segment<Coord>& b = segments[j];
+                // excecoes do teste par a par: vertice compartilhado
+                if (a.u == b.u || a.u == b.v || a.v == b.u || a.v == b.v) continue;
+                tested.push_back(j);
+                pairs.add(a.p, a.q, b.p, b.q);
+            }
+
+            Stats::tick(Stats::SEGMENT_PAIRS, pairs.size());
+            Geometry::segmentsIntersectBatch(pairs, hits);
+            for (size_t k = 0; k < tested.size(); k++) {
+                if ((hits[k / 64] >> (k % 64)) & 1) {
+                    const Sweep::Segment<Coord>& b = segments[tested[k]];
+                    diagnosis.overlaps.push_back({segmentEdge[i], segmentEdge[tested[k]],
+                                                  a.p, a.q, b.p, b.q});
+                }
+            }
+        }
+    }
+
+    // arestas abertas tem prioridade, como em validate(); toda aresta usada por
+    // mais de duas faces tambem eh aberta
+    if (!diagnosis.edges.empty()) {
+        diagnosis.verdict = Verdict::OPEN;
+    } else if (!diagnosis.vertices.empty()) {
+        diagnosis.verdict = Verdict::NON_PLANAR;
+    } else if (!diagnosis.overlaps.empty()) {
+        diagnosis.verdict = Verdict::OVERLAPPING;
+    }
+}
+
+template <typename Coord>
+bool writeDiagnosis(const BasicDCEL<Coord>& dcel, const BasicDiagnosis<Coord>& diagnosis, int fd) {
+    OutputBuffer out(fd);
+
+    out.put("{\"verdict\":\"");
+    out.put(verdictCode(diagnosis.verdict));
+    out.put("\",\"edge_defects\":");
+    out.putNumber(diagnosis.edges.size());
+    out.put(",\"vertex_defects\":");
+    out.putNumber(diagnosis.vertices.size());
+    out.put(",\"overlaps\":");
+    out.putNumber(diagnosis.overlaps.size());
+    out.put("}\n");
+
+    for (const auto& defect : diagnosis.edges) {
+        out.put("{\"defect\":\"");
+        out.put(EDGE_PROBLEM_NAMES[(int)defect.problem]);
+        out.put("\",\"edge\":");
+        putIndexList(out, {defect.from, defect.to});
+        out.put(",\"half_edges\":");
+        putIndexList(out, defect.halfEdges);
+        out.put(",\"faces\":");
+        putIndexList(out, facesOf(dcel, defect.halfEdges, false));
+        out.put("}\n");
+    }
+
+    for (const auto& defect : diagnosis.vertices) {
+        out.put("{\"defect\":\"inconsistent_orientation\",\"vertex\":");
+        out.putNumber(defect.vertex + 1);
+        out.put(",\"half_edges\":");
+        putIndexList(out, defect.halfEdges);
+        out.put(",\"faces\":");
+        putIndexList(out, facesOf(dcel, defect.halfEdges, false));
+        out.put("}\n");
+    }
+
+    for (const auto& overlap : diagnosis.overlaps) {
+        out.put("{\"defect\":\"overlap\",\"half_edges\":");
+        putIndexList(out, {overlap.first, overlap.second});
+        out.put(",\"faces\":[");
+        putIndexList(out, facesOf(dcel, {overlap.first}, true));
+        out.put(',');
+        putIndexList(out, facesOf(dcel, {overlap.second}, true));
+        out.put("],\"segments\":[");
+        putSegment(out, overlap.firstStart, overlap.firstEnd);
+        out.put(',');
+        putSegment(out, overlap.secondStart, overlap.secondEnd);
+        out.put("]}\n");
+    }
+
+    return out.flush();
+}
+
+// instancias para cada largura de coordenada (coordinate.h)
+#define INSTANTIATE_DIAGNOSIS(Coord)                                                        \
+    template uint32_t BasicDCEL<Coord>::cycleDestination(uint32_t) const;                  \
+    template void BasicDCEL<Coord>::diagnose(BasicDiagnosis<Coord>&) const;                \
+    template bool writeDiagnosis(const BasicDCEL<Coord>&, const BasicDiagnosis<Coord>&, int);
+
+INSTANTIATE_DIAGNOSIS(int16_t)
+INSTANTIATE_DIAGNOSIS(int32_t)
+INSTANTIATE_DIAGNOSIS(int64_t)
+#undef INSTANTIATE_DIAGNOSIS
@@ -0,0 +1,56 @@
+#ifndef DIAGNOSIS_H
+#define DIAGNOSIS_H
+
+#include "DCEL.h"
+#include <vector>
+#include <cstdint>
+
+// todos os defeitos de uma malha, coletados por DCEL::diagnose em uma unica
+// passada (diagnosis.cpp) em vez de parar no primeiro criterio que falha como
+// validate(); indices internos 0-based
+template <typename Coord>
+struct BasicDiagnosis {
+    using Point = BasicPoint<Coord>;
+
+    enum class EdgeProblem {
+        BOUNDARY,    // usada por uma unica face (aberta)
+        SAME_FACE,   // as duas half-edges na mesma face (aberta)
+        OVERUSED     // usada por mais de duas faces (aberta e nao planar)
+    };
+
+    // aresta geometrica e as half-edges de cada face que a usa
+    struct EdgeDefect {
+        EdgeProblem problem;
+        uint32_t from, to;
+        std::vector<uint32_t> halfEdges;
+    };
+
+    // vertice em que dois ou mais pares de twins tem a mesma direcao (faces com
+    // orientacao inconsistente em torno dele; nao planar)
+    struct VertexDefect {
+        uint32_t vertex;
+        std::vector<uint32_t> halfEdges;
+    };
+
+    // par de arestas que se cruzam ou se sobrepoem, com uma half-edge de cada
+    struct Overlap {
+        uint32_t first, second;
+        Point firstStart, firstEnd;
+        Point secondStart, secondEnd;
+    };
+
+    // mesmo veredito que validate() daria, pela prioridade aberta, nao planar, superposta
+    DCELBase::Verdict verdict = DCELBase::Verdict::VALID;
+    std::vector<EdgeDefect> edges;
+    std::vector<VertexDefect> vertices;
+    std::vector<Overlap> overlaps;
+};
+
+using Diagnosis = BasicDiagnosis<int32_t>;
+
+// relatorio em JSON Lines (1-based como printDCEL): primeiro um resumo com o
+// veredito e as contagens, depois um objeto por defeito; false se a escrita falhar
+template <typename Coord>
+bool writeDiagnosis(const BasicDCEL<Coord>& dcel, const BasicDiagnosis<Coord>& diagnosis, int fd);
+
+#endif
@@ -1,44 +1,85 @@
 #include <iostream>
 #include <vector>
-#include <fstream>
-#include <sstream>
+#include <string>
 #include <algorithm>
 #include <cmath>
-#include <iomanip>
+#include <cstring>
+#include <cstdlib>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include "DCEL.h"
+#include "metrics.h"
+#include "parser.h"
+#include "writer.h"
 
 using namespace std;
 
-struct Point {
-    int x, y;
-    Point() : x(0), y(0) {}
-    Point(int x, int y) : x(x), y(y) {}
-};
-
+// Coordinates stay in the parser's 64 bits; they are only narrowed to screen
+// pixels after scaling, in double
 struct InputMesh {
-    vector<Point> vertices;
-    vector<vector<int>> faces;
+    MeshData data;  // faces in compact form (1-indexed vertex lists)
     int nVertices, nFaces;
 };
 
-struct DCELVertex {
-    Point p;
-    int halfEdge;
-};
+// Accumulates subpaths into <path> elements sharing one set of attributes,
+// starting a new element every PATH_BATCH commands to keep elements small
+class PathBatch {
+private:
+    static const size_t PATH_BATCH = 4096;
 
-struct DCELFace {
-    int halfEdge;
-};
+    OutputBuffer& out;
+    string attributes;
+    size_t commands = 0;
+    Point current;
 
-struct DCELHalfEdge {
-    int origin, twin, face, next, prev;
-};
+    void putPoint(const Point& p) {
+        out.putNumber(p.x);
+        out.put(' ');
+        out.putNumber(p.y);
+        current = p;
+    }
 
-struct DCEL {
-    vector<DCELVertex> vertices;
-    vector<DCELFace> faces;
-    vector<DCELHalfEdge> halfEdges;
-    int nVertices, nEdges, nFaces;
-    bool isValid;
+public:
+    PathBatch(OutputBuffer& out, const string& attributes) : out(out), attributes(attributes) {}
+    ~PathBatch() { close(); }
+
+    void moveTo(const Point& p) {
+        if (commands >= PATH_BATCH) close();
+        if (commands == 0) {
+            out.put("<path ");
+            out.put(attributes.c_str());
+            out.put(" d=\"");
+        }
+        commands++;
+        out.put('M');
+        putPoint(p);
+    }
+
+    void lineTo(const Point& p) {
+        commands++;
+        out.put('L');
+        putPoint(p);
+    }
+
+    // Straight segment, continuing the current subpath when it ends at from
+    void segment(const Point& from, const Point& to) {
+        if (commands == 0 || commands >= PATH_BATCH || current != from) moveTo(from);
+        lineTo(to);
+    }
+
+    // Zero-length segment: drawn as a dot with round line caps
+    void dot(const Point& p) {
+        moveTo(p);
+        out.put("h0");
+    }
+
+    void closePath() { out.put('Z'); }
+
+    void close() {
+        if (commands > 0) out.put("\"/>\n");
+        commands = 0;
+    }
 };
 
 class SVGDrawer {
@@ -47,21 +88,104 @@ private:
     double width, height;
     double scale;
     double offsetX, offsetY;
+    double labelSpacing;  // minimum average spacing (px) for labels and arrows
+    
+    // Labels (and half-edge arrows) are only drawn when count items spread
+    // over the drawing leave at least labelSpacing pixels between them
+    bool showLabels(size_t count) const {
+        return count == 0 || sqrt(width * height / count) >= labelSpacing;
+    }
+    
+    bool openFile(const string& filename, int& fd) {
+        fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            cerr << "Error writing " << filename << ": " << strerror(errno) << endl;
+            return false;
+        }
+        return true;
+    }
+    
+    bool closeFile(OutputBuffer& out, int fd, const string& filename) {
+        bool written = out.flush();
+        if (close(fd) != 0 || !written) {
+            cerr << "Error writing " << filename << endl;
+            return false;
+        }
+        return true;
+    }
+    
+    void writeHeader(OutputBuffer& out, const char* title) {
+        out.put("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<svg width=\"");
+        out.putNumber((int)width);
+        out.put("\" height=\"");
+        out.putNumber((int)height);
+        out.put("\" xmlns=\"http://www.w3.org/2000/svg\">\n<title>");
+        out.put(title);
+        out.put("</title>\n");
+    }
+    
+    void writeText(OutputBuffer& out, int x, int y, const char* prefix, size_t number) {
+        out.put("<text x=\"");
+        out.putNumber(x);
+        out.put("\" y=\"");
+        out.putNumber(y);
+        out.put("\">");
+        out.put(prefix);
+        out.putNumber(number);
+        out.put("</text>\n");
+    }
+    
+    void writeLegendLine(OutputBuffer& out, int y, const char* style, const char* text, long long count = -1) {
+        out.put("<text x=\"10\" y=\"");
+        out.putNumber(y);
+        out.put("\" font-family=\"Arial\" ");
+        out.put(style);
+        out.put(">");
+        out.put(text);
+        if (count >= 0) out.putNumber(count);
+        out.put("</text>\n");
+    }
+    
+    // Red vertex dots, optionally with a darker outline, and their labels
+    void writeVertices(OutputBuffer& out, const vector<Point>& screen, int radius, bool outline,
+                       int labelOffset, const char* labelStyle) {
+        if (outline) {
+            PathBatch rims(out, "fill=\"none\" stroke=\"darkred\" stroke-linecap=\"round\" stroke-width=\"" +
+                                to_string(2 * radius + 2) + "\"");
+            for (const Point& p : screen) rims.dot(p);
+        }
+        PathBatch dots(out, "fill=\"none\" stroke=\"red\" stroke-linecap=\"round\" stroke-width=\"" +
+                            to_string(outline ? 2 * radius - 2 : 2 * radius) + "\"");
+        for (const Point& p : screen) dots.dot(p);
+        dots.close();
+        
+        if (showLabels(screen.size())) {
+            out.put("<g font-family=\"Arial\" font-size=\"12\" fill=\"black\"");
+            out.put(labelStyle);
+            out.put(">\n");
+            for (size_t i = 0; i < screen.size(); i++) {
+                writeText(out, screen[i].x + labelOffset, screen[i].y - labelOffset, "", i + 1);
+            }
+            out.put("</g>\n");
+        }
+    }
     
 public:
-    SVGDrawer() : width(800), height(600) {}
+    SVGDrawer() : width(800), height(600), labelSpacing(20) {}
     
-    void calculateBounds(const vector<Point>& vertices) {
-        if (vertices.empty()) return;
+    void setLabelSpacing(double spacing) { labelSpacing = spacing; }
+    
+    void calculateBounds(const vector<double>& x, const vector<double>& y) {
+        if (x.empty()) return;
         
-        minX = maxX = vertices[0].x;
-        minY = maxY = vertices[0].y;
+        minX = maxX = x[0];
+        minY = maxY = y[0];
         
-        for (const auto& v : vertices) {
-            minX = min(minX, (double)v.x);
-            maxX = max(maxX, (double)v.x);
-            minY = min(minY, (double)v.y);
-            maxY = max(maxY, (double)v.y);
+        for (size_t i = 0; i < x.size(); i++) {
+            minX = min(minX, x[i]);
+            maxX = max(maxX, x[i]);
+            minY = min(minY, y[i]);
+            maxY = max(maxY, y[i]);
         }
         
         // Add padding
@@ -78,269 +202,263 @@ public:
         offsetY = height - padding + minY * scale; // SVG Y is flipped
     }
     
-    Point transform(const Point& p) {
+    // Plane coordinates (any width, as double) to screen pixels
+    Point transform(double x, double y) {
         return Point(
-            (int)(p.x * scale + offsetX),
-            (int)(offsetY - p.y * scale)  // Flip Y coordinate
+            (int)(x * scale + offsetX),
+            (int)(offsetY - y * scale)  // Flip Y coordinate
         );
     }
     
+    // Bounds and screen positions of all vertices at once
+    vector<Point> project(const vector<double>& x, const vector<double>& y) {
+        calculateBounds(x, y);
+        vector<Point> screen(x.size());
+        for (size_t i = 0; i < screen.size(); i++) {
+            screen[i] = transform(x[i], y[i]);
+        }
+        return screen;
+    }
+    
     void drawInputMesh(const InputMesh& mesh, const string& filename) {
-        ofstream file(filename);
+        int fd;
+        if (!openFile(filename, fd)) return;
+        OutputBuffer out(fd);
         
-        file << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
-        file << "<svg width=\"" << width << "\" height=\"" << height << "\" xmlns=\"http://www.w3.org/2000/svg\">\n";
-        file << "<title>Input Mesh</title>\n";
+        writeHeader(out, "Input Mesh");
         
-        calculateBounds(mesh.vertices);
+        // Screen positions are computed once per vertex
+        vector<Point> screen = project(vector<double>(mesh.data.vertexX.begin(), mesh.data.vertexX.end()),
+                                       vector<double>(mesh.data.vertexY.begin(), mesh.data.vertexY.end()));
         
-        // Draw faces
-        for (size_t i = 0; i < mesh.faces.size(); i++) {
-            const auto& face = mesh.faces[i];
-            
-            file << "<polygon points=\"";
-            for (size_t j = 0; j < face.size(); j++) {
-                Point p = transform(mesh.vertices[face[j] - 1]); // Convert from 1-indexed
-                file << p.x << "," << p.y;
-                if (j < face.size() - 1) file << " ";
+        // Draw faces: the fill color repeats every 51 faces, so faces are
+        // batched by color class instead of one <polygon> each
+        const size_t COLOR_PERIOD = 51;
+        size_t nFaces = mesh.data.getFaceCount();
+        for (size_t color = 0; color < min(COLOR_PERIOD, nFaces); color++) {
+            PathBatch faces(out, "fill=\"rgba(" + to_string((50 + color * 40) % 255) + "," +
+                                 to_string((100 + color * 60) % 255) + "," +
+                                 to_string((150 + color * 80) % 255) +
+                                 ",0.3)\" stroke=\"black\" stroke-width=\"2\"");
+            for (size_t i = color; i < nFaces; i += COLOR_PERIOD) {
+                bool started = false;
+                for (size_t j = mesh.data.faceStart[i]; j < mesh.data.faceStart[i + 1]; j++) {
+                    int v = mesh.data.faceVertices[j] - 1; // Convert from 1-indexed
+                    if (v < 0 || v >= (int)screen.size()) continue;
+                    if (started) {
+                        faces.lineTo(screen[v]);
+                    } else {
+                        faces.moveTo(screen[v]);
+                        started = true;
+                    }
+                }
+                if (started) faces.closePath();
             }
-            file << "\" fill=\"rgba(" << (50 + i * 40) % 255 << "," << (100 + i * 60) % 255 << "," 
-                 << (150 + i * 80) % 255 << ",0.3)\" stroke=\"black\" stroke-width=\"2\"/>\n";
         }
         
         // Draw vertices
-        for (size_t i = 0; i < mesh.vertices.size(); i++) {
-            Point p = transform(mesh.vertices[i]);
-            file << "<circle cx=\"" << p.x << "\" cy=\"" << p.y << "\" r=\"5\" fill=\"red\"/>\n";
-            file << "<text x=\"" << p.x + 8 << "\" y=\"" << p.y - 8 << "\" font-family=\"Arial\" font-size=\"12\" fill=\"black\">" 
-                 << (i + 1) << "</text>\n";
-        }
+        writeVertices(out, screen, 5, false, 8, "");
         
         // Add legend
-        file << "<text x=\"10\" y=\"30\" font-family=\"Arial\" font-size=\"16\" fill=\"black\" font-weight=\"bold\">Input Mesh</text>\n";
-        file << "<text x=\"10\" y=\"50\" font-family=\"Arial\" font-size=\"12\" fill=\"black\">Vertices: " << mesh.nVertices << "</text>\n";
-        file << "<text x=\"10\" y=\"70\" font-family=\"Arial\" font-size=\"12\" fill=\"black\">Faces: " << mesh.nFaces << "</text>\n";
-        
-        file << "</svg>\n";
-        file.close();
+        writeLegendLine(out, 30, "font-size=\"16\" fill=\"black\" font-weight=\"bold\"", "Input Mesh");
+        writeLegendLine(out, 50, "font-size=\"12\" fill=\"black\"", "Vertices: ", mesh.nVertices);
+        writeLegendLine(out, 70, "font-size=\"12\" fill=\"black\"", "Faces: ", mesh.nFaces);
         
-        cout << "Input mesh drawn to: " << filename << endl;
+        out.put("</svg>\n");
+        if (closeFile(out, fd, filename)) {
+            cout << "Input mesh drawn to: " << filename << "\n";
+        }
     }
     
-    void drawDCEL(const DCEL& dcel, const string& filename) {
-        ofstream file(filename);
+    template <typename Coord>
+    void drawDCEL(const BasicDCEL<Coord>& dcel, const string& filename) {
+        const uint32_t NONE = DCELBase::NONE;
+        int fd;
+        if (!openFile(filename, fd)) return;
+        OutputBuffer out(fd);
         
-        file << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
-        file << "<svg width=\"" << width << "\" height=\"" << height << "\" xmlns=\"http://www.w3.org/2000/svg\">\n";
-        file << "<title>DCEL Structure</title>\n";
+        writeHeader(out, "DCEL Structure");
         
-        vector<Point> vertices;
-        for (const auto& v : dcel.vertices) {
-            vertices.push_back(v.p);
+        vector<double> x(dcel.getVertexCount()), y(dcel.getVertexCount());
+        for (uint32_t v = 0; v < x.size(); v++) {
+            x[v] = (double)dcel.vertexPosition(v).x;
+            y[v] = (double)dcel.vertexPosition(v).y;
         }
-        calculateBounds(vertices);
+        vector<Point> screen = project(x, y);
         
-        // Draw half-edges
-        for (size_t i = 0; i < dcel.halfEdges.size(); i++) {
-            const auto& he = dcel.halfEdges[i];
-            Point p1 = transform(dcel.vertices[he.origin - 1].p); // Convert from 1-indexed
-            
-            // Find destination vertex (origin of next half-edge)
-            int nextHE = he.next - 1;
-            Point p2 = transform(dcel.vertices[dcel.halfEdges[nextHE].origin - 1].p);
-            
-            // Draw edge
-            file << "<line x1=\"" << p1.x << "\" y1=\"" << p1.y << "\" x2=\"" << p2.x << "\" y2=\"" << p2.y 
-                 << "\" stroke=\"blue\" stroke-width=\"1.5\"/>\n";
-            
-            // Draw arrow to show direction
-            double dx = p2.x - p1.x;
-            double dy = p2.y - p1.y;
-            double len = sqrt(dx*dx + dy*dy);
-            if (len > 0) {
-                dx /= len; dy /= len;
-                double midX = p1.x + dx * len * 0.7;
-                double midY = p1.y + dy * len * 0.7;
-                double arrowSize = 8;
-                
-                file << "<polygon points=\"" 
-                     << (midX + dx * arrowSize) << "," << (midY + dy * arrowSize) << " "
-                     << (midX - dx * arrowSize + dy * arrowSize * 0.5) << "," << (midY - dy * arrowSize - dx * arrowSize * 0.5) << " "
-                     << (midX - dx * arrowSize - dy * arrowSize * 0.5) << "," << (midY - dy * arrowSize + dx * arrowSize * 0.5)
-                     << "\" fill=\"blue\"/>\n";
+        // Draw half-edges. Arrows and labels only fit on sparse drawings:
+        // then each half-edge is a short path whose middle vertex (70% of the
+        // way) carries the shared arrowhead marker. Otherwise each edge is
+        // drawn once, batched, without decoration.
+        size_t nHalfEdges = dcel.getHalfEdgeCount();
+        bool halfEdgeLabels = showLabels(nHalfEdges);
+        if (halfEdgeLabels) {
+            out.put("<defs><marker id=\"arrow\" markerUnits=\"userSpaceOnUse\" viewBox=\"-8 -4 16 8\" "
+                    "markerWidth=\"16\" markerHeight=\"8\" orient=\"auto\">"
+                    "<path d=\"M8 0L-8 4L-8 -4Z\" fill=\"blue\"/></marker></defs>\n");
+            out.put("<g fill=\"none\" stroke=\"blue\" stroke-width=\"1.5\" marker-mid=\"url(#arrow)\">\n");
+            for (uint32_t he = 0; he < nHalfEdges; he++) {
+                // Destination vertex is the origin of the next half-edge; the
+                // validator accepts same-direction twins, which leave some
+                // half-edges without one, and those are skipped
+                uint32_t next = dcel.next(he);
+                if (next == NONE) continue;
+                Point p1 = screen[dcel.origin(he)];
+                Point p2 = screen[dcel.origin(next)];
+                Point mid((int)lround(p1.x + (p2.x - p1.x) * 0.7), (int)lround(p1.y + (p2.y - p1.y) * 0.7));
+                out.put("<path d=\"M");
+                out.putNumber(p1.x);
+                out.put(' ');
+                out.putNumber(p1.y);
+                out.put('L');
+                out.putNumber(mid.x);
+                out.put(' ');
+                out.putNumber(mid.y);
+                out.put('L');
+                out.putNumber(p2.x);
+                out.put(' ');
+                out.putNumber(p2.y);
+                out.put("\"/>\n");
             }
+            out.put("</g>\n");
             
-            // Label half-edge
-            double midX = (p1.x + p2.x) / 2;
-            double midY = (p1.y + p2.y) / 2;
-            file << "<text x=\"" << midX << "\" y=\"" << midY << "\" font-family=\"Arial\" font-size=\"10\" fill=\"darkblue\" text-anchor=\"middle\">" 
-                 << (i + 1) << "</text>\n";
+            // Label half-edges
+            out.put("<g font-family=\"Arial\" font-size=\"10\" fill=\"darkblue\" text-anchor=\"middle\">\n");
+            for (uint32_t he = 0; he < nHalfEdges; he++) {
+                uint32_t next = dcel.next(he);
+                if (next == NONE) continue;
+                Point p1 = screen[dcel.origin(he)];
+                Point p2 = screen[dcel.origin(next)];
+                writeText(out, (p1.x + p2.x) / 2, (p1.y + p2.y) / 2, "", he + 1);
+            }
+            out.put("</g>\n");
+        } else {
+            PathBatch edges(out, "fill=\"none\" stroke=\"blue\" stroke-width=\"1.5\"");
+            for (uint32_t he = 0; he < nHalfEdges; he++) {
+                // Each edge once, from the first of its half-edges that has a next
+                uint32_t twin = dcel.twin(he), next = dcel.next(he);
+                if (next == NONE) continue;
+                if (twin != NONE && twin < he && dcel.next(twin) != NONE) continue;
+                edges.segment(screen[dcel.origin(he)], screen[dcel.origin(next)]);
+            }
         }
         
         // Draw vertices
-        for (size_t i = 0; i < dcel.vertices.size(); i++) {
-            Point p = transform(dcel.vertices[i].p);
-            file << "<circle cx=\"" << p.x << "\" cy=\"" << p.y << "\" r=\"6\" fill=\"red\" stroke=\"darkred\" stroke-width=\"2\"/>\n";
-            file << "<text x=\"" << p.x + 10 << "\" y=\"" << p.y - 10 << "\" font-family=\"Arial\" font-size=\"12\" fill=\"black\" font-weight=\"bold\">" 
-                 << (i + 1) << "</text>\n";
-        }
+        writeVertices(out, screen, 6, true, 10, " font-weight=\"bold\"");
         
         // Draw face labels
-        for (size_t i = 0; i < dcel.faces.size(); i++) {
-            // Find center of face by averaging vertices
-            int startHE = dcel.faces[i].halfEdge - 1;
-            int currentHE = startHE;
-            vector<Point> faceVertices;
-            
-            do {
-                faceVertices.push_back(dcel.vertices[dcel.halfEdges[currentHE].origin - 1].p);
-                currentHE = dcel.halfEdges[currentHE].next - 1;
-            } while (currentHE != startHE && faceVertices.size() < 20); // Safety check
-            
-            if (!faceVertices.empty()) {
-                double centerX = 0, centerY = 0;
-                for (const auto& v : faceVertices) {
-                    centerX += v.x;
-                    centerY += v.y;
-                }
-                centerX /= faceVertices.size();
-                centerY /= faceVertices.size();
+        if (showLabels(dcel.getFaceCount())) {
+            out.put("<g font-family=\"Arial\" font-size=\"14\" fill=\"green\" font-weight=\"bold\" text-anchor=\"middle\">\n");
+            // Each label sits at the polygon centroid, computed for all faces at once
+            BasicFaceMetrics<Coord> metrics;
+            metrics.compute(dcel);
+            for (uint32_t f = 0; f < dcel.getFaceCount(); f++) {
+                if (dcel.outerComponent(f) == NONE) continue;
+                double centerX = metrics.centroidX(f);
+                double centerY = metrics.centroidY(f);
                 
-                Point center = transform(Point((int)centerX, (int)centerY));
-                file << "<text x=\"" << center.x << "\" y=\"" << center.y << "\" font-family=\"Arial\" font-size=\"14\" fill=\"green\" font-weight=\"bold\" text-anchor=\"middle\">F" 
-                     << (i + 1) << "</text>\n";
+                Point center = transform(centerX, centerY);
+                writeText(out, center.x, center.y, "F", f + 1);
             }
+            out.put("</g>\n");
         }
         
         // Add legend
-        file << "<text x=\"10\" y=\"30\" font-family=\"Arial\" font-size=\"16\" fill=\"black\" font-weight=\"bold\">DCEL Structure</text>\n";
-        file << "<text x=\"10\" y=\"50\" font-family=\"Arial\" font-size=\"12\" fill=\"black\">Vertices: " << dcel.nVertices << "</text>\n";
-        file << "<text x=\"10\" y=\"70\" font-family=\"Arial\" font-size=\"12\" fill=\"black\">Edges: " << dcel.nEdges << "</text>\n";
-        file << "<text x=\"10\" y=\"90\" font-family=\"Arial\" font-size=\"12\" fill=\"black\">Faces: " << dcel.nFaces << "</text>\n";
-        file << "<text x=\"10\" y=\"110\" font-family=\"Arial\" font-size=\"12\" fill=\"blue\">Blue arrows: Half-edges</text>\n";
-        file << "<text x=\"10\" y=\"130\" font-family=\"Arial\" font-size=\"12\" fill=\"red\">Red circles: Vertices</text>\n";
-        file << "<text x=\"10\" y=\"150\" font-family=\"Arial\" font-size=\"12\" fill=\"green\">Green labels: Faces</text>\n";
-        
-        file << "</svg>\n";
-        file.close();
+        writeLegendLine(out, 30, "font-size=\"16\" fill=\"black\" font-weight=\"bold\"", "DCEL Structure");
+        writeLegendLine(out, 50, "font-size=\"12\" fill=\"black\"", "Vertices: ", dcel.getVertexCount());
+        writeLegendLine(out, 70, "font-size=\"12\" fill=\"black\"", "Edges: ", dcel.getEdgeCount());
+        writeLegendLine(out, 90, "font-size=\"12\" fill=\"black\"", "Faces: ", dcel.getFaceCount());
+        writeLegendLine(out, 110, "font-size=\"12\" fill=\"blue\"",
+                        halfEdgeLabels ? "Blue arrows: Half-edges" : "Blue lines: Edges (too dense for arrows)");
+        writeLegendLine(out, 130, "font-size=\"12\" fill=\"red\"", "Red circles: Vertices");
+        writeLegendLine(out, 150, "font-size=\"12\" fill=\"green\"", "Green labels: Faces");
         
-        cout << "DCEL drawn to: " << filename << endl;
+        out.put("</svg>\n");
+        if (closeFile(out, fd, filename)) {
+            cout << "DCEL drawn to: " << filename << "\n";
+        }
     }
 };
 
-InputMesh readInput() {
-    InputMesh mesh;
-    
-    cin >> mesh.nVertices >> mesh.nFaces;
-    
-    mesh.vertices.resize(mesh.nVertices);
-    for (int i = 0; i < mesh.nVertices; i++) {
-        cin >> mesh.vertices[i].x >> mesh.vertices[i].y;
-    }
-    
-    mesh.faces.resize(mesh.nFaces);
-    string line;
-    getline(cin, line); // consume newline
-    
-    for (int i = 0; i < mesh.nFaces; i++) {
-        getline(cin, line);
-        stringstream ss(line);
-        int vertex;
-        while (ss >> vertex) {
-            mesh.faces[i].push_back(vertex);
-        }
+bool readInput(const char* path, InputMesh& mesh) {
+    // Shared fast parser (mmap for files, large buffered reads for pipes)
+    MeshParser parser;
+    bool opened = path ? parser.openFile(path) : parser.openStdin();
+    if (!opened || !parser.parse(mesh.data)) {
+        cerr << "Error reading input: " << parser.getError() << endl;
+        return false;
     }
     
-    return mesh;
+    mesh.nVertices = mesh.data.getVertexCount();
+    mesh.nFaces = mesh.data.getFaceCount();
+    return true;
 }
 
-DCEL runMalhaAndParseDCEL(const InputMesh& mesh) {
-    DCEL dcel;
-    dcel.isValid = false;
+template <typename Coord>
+bool buildDCEL(const InputMesh& mesh, BasicDCEL<Coord>& dcel) {
+    // Build and validate in-process with the DCEL library
+    if (!dcel.loadFromMesh(mesh.data)) {
+        return false;
+    }
     
-    // Write input to temporary file
-    ofstream tempInput("temp_input.txt");
-    tempInput << mesh.nVertices << " " << mesh.nFaces << "\n";
-    for (const auto& v : mesh.vertices) {
-        tempInput << v.x << " " << v.y << "\n";
+    DCELBase::Verdict verdict = dcel.validate();
+    if (verdict != DCELBase::Verdict::VALID) {
+        cout << "Mesh validation failed: " << DCELBase::verdictName(verdict) << endl;
+        return false;
     }
-    for (const auto& face : mesh.faces) {
-        for (size_t i = 0; i < face.size(); i++) {
-            tempInput << face[i];
-            if (i < face.size() - 1) tempInput << " ";
-        }
-        tempInput << "\n";
+    return true;
+}
+
+template <typename Coord>
+bool drawStructure(const InputMesh& mesh, SVGDrawer& drawer) {
+    BasicDCEL<Coord> dcel;
+    if (!buildDCEL(mesh, dcel)) {
+        return false;
     }
-    tempInput.close();
-    
-    // Run malha program
-    int result = system("./malha < temp_input.txt > temp_output.txt 2>&1");
-    
-    if (result == 0) {
-        // Read output
-        ifstream output("temp_output.txt");
-        string firstLine;
-        getline(output, firstLine);
-        
-        // Check if it's an error message
-        if (firstLine == "aberta" || firstLine == "não subdivisão planar" || firstLine == "superposta") {
-            cout << "Mesh validation failed: " << firstLine << endl;
-            output.close();
-            system("rm -f temp_input.txt temp_output.txt");
-            return dcel;
-        }
-        
-        // Parse DCEL output
-        stringstream ss(firstLine);
-        ss >> dcel.nVertices >> dcel.nEdges >> dcel.nFaces;
-        
-        dcel.vertices.resize(dcel.nVertices);
-        dcel.faces.resize(dcel.nFaces);
-        dcel.halfEdges.resize(dcel.nEdges * 2);
-        
-        // Read vertices
-        for (int i = 0; i < dcel.nVertices; i++) {
-            output >> dcel.vertices[i].p.x >> dcel.vertices[i].p.y >> dcel.vertices[i].halfEdge;
-        }
-        
-        // Read faces
-        for (int i = 0; i < dcel.nFaces; i++) {
-            output >> dcel.faces[i].halfEdge;
-        }
-        
-        // Read half-edges
-        for (int i = 0; i < dcel.nEdges * 2; i++) {
-            output >> dcel.halfEdges[i].origin >> dcel.halfEdges[i].twin 
-                   >> dcel.halfEdges[i].face >> dcel.halfEdges[i].next >> dcel.halfEdges[i].prev;
+    cout << "DCEL is valid! Drawing DCEL structure..." << endl;
+    drawer.drawDCEL(dcel, "dcel_structure.svg");
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    // Optional input file (defaults to stdin) and label density threshold
+    const char* path = nullptr;
+    SVGDrawer drawer;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--label-spacing") == 0 && i + 1 < argc) {
+            drawer.setLabelSpacing(atof(argv[++i]));
+        } else if (strcmp(argv[i], "-") != 0) {
+            path = argv[i];
         }
-        
-        dcel.isValid = true;
-        output.close();
     }
     
-    // Clean up temporary files
-    system("rm -f temp_input.txt temp_output.txt");
-    
-    return dcel;
-}
-
-int main() {
     cout << "Reading input mesh..." << endl;
-    InputMesh mesh = readInput();
-    
-    SVGDrawer drawer;
+    InputMesh mesh;
+    if (!readInput(path, mesh)) {
+        return 1;
+    }
     
     // Draw input mesh
     drawer.drawInputMesh(mesh, "input_mesh.svg");
     
-    // Try to generate and draw DCEL
-    cout << "Running malha to generate DCEL..." << endl;
-    DCEL dcel = runMalhaAndParseDCEL(mesh);
+    // Try to generate and draw DCEL, in the narrowest exact coordinate width
+    // (as malha does)
+    cout << "Building DCEL..." << endl;
+    int64_t low = 0, high = 0;
+    mesh.data.coordinateRange(low, high);
+    CoordinateWidth width;
+    bool drawn = false;
+    if (!narrowestWidth(low, high, width)) {
+        cerr << "Error: coordinates outside the supported range (-2^62, 2^62)" << endl;
+    } else if (width == CoordinateWidth::BITS16) {
+        drawn = drawStructure<int16_t>(mesh, drawer);
+    } else if (width == CoordinateWidth::BITS32) {
+        drawn = drawStructure<int32_t>(mesh, drawer);
+    } else {
+        drawn = drawStructure<int64_t>(mesh, drawer);
+    }
     
-    if (dcel.isValid) {
-        cout << "DCEL is valid! Drawing DCEL structure..." << endl;
-        drawer.drawDCEL(dcel, "dcel_structure.svg");
-        
+    if (drawn) {
         cout << "\nFiles generated:" << endl;
         cout << "- input_mesh.svg: Original mesh visualization" << endl;
         cout << "- dcel_structure.svg: DCEL structure visualization" << endl;
@@ -0,0 +1,194 @@
+#include "dual.h"
+#include "writer.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <thread>
+
+// formato binario do grafo dual (versao 1), na ordem de bytes do proprio host e
+// com o mesmo alinhamento do snapshot: cabecalho de 64 bytes e depois offsets
+// (faces + 1 valores), neighbors e edges (entradas valores cada), todos uint32_t
+
+namespace {
+    const char DUAL_MAGIC[8] = {'D', 'C', 'E', 'L', 'D', 'U', 'A', 'L'};
+    const uint32_t DUAL_VERSION = 1;
+    const uint32_t BYTE_ORDER_MARK = 0x01020304;
+    const size_t DUAL_ALIGN = 64;
+
+    struct DualHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrder;
+        uint64_t faceCount;
+        uint64_t entryCount;
+        uint32_t reserved[8];
+    };
+    static_assert(sizeof(DualHeader) == DUAL_ALIGN, "cabecalho deve ocupar 64 bytes");
+
+    // mesma divisao dinamica de metrics.cpp: a face externa sozinha pode ter
+    // tantas half-edges quanto o resto
+    const size_t FACES_PER_BLOCK = 1024;
+
+    bool writeArray(FILE* file, const std::vector<uint32_t>& values) {
+        static const char padding[DUAL_ALIGN] = {};
+        size_t bytes = values.size() * sizeof(uint32_t);
+        if (bytes > 0 && fwrite(values.data(), 1, bytes, file) != bytes) {
+            return false;
+        }
+        size_t gap = (DUAL_ALIGN - bytes % DUAL_ALIGN) % DUAL_ALIGN;
+        return gap == 0 || fwrite(padding, 1, gap, file) == gap;
+    }
+
+    // aplica visit a todas as faces em blocos, com a thread que chama participando
+    template <typename Visit>
+    void forEachFace(size_t faces, unsigned threads, const Visit& visit) {
+        if (threads == 0) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        threads = (unsigned)std::min<size_t>(threads, faces / FACES_PER_BLOCK + 1);
+
+        std::atomic<size_t> nextBlock(0);
+        auto work = [&]() {
+            for (;;) {
+                size_t begin = nextBlock.fetch_add(FACES_PER_BLOCK, std::memory_order_relaxed);
+                if (begin >= faces) {
+                    break;
+                }
+                size_t end = std::min(faces, begin + FACES_PER_BLOCK);
+                for (size_t f = begin; f < end; f++) {
+                    visit((uint32_t)f);
+                }
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (unsigned t = 1; t < threads; t++) {
+            workers.emplace_back(work);
+        }
+        work();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    // half-edges de f com twin, na ordem do ciclo: o mesmo percurso (limitado,
+    // ver circulator.h) nas duas passadas de build. false quando o ciclo nao
+    // volta a outerComponent, por parar em NONE ou no limite de passos
+    template <typename Coord, typename Visit>
+    bool walkNeighbors(const BasicDCEL<Coord>& dcel, uint32_t f, const Visit& visit) {
+        const uint32_t NONE = BasicDCEL<Coord>::NONE;
+        uint32_t last = NONE;
+        for (uint32_t he : dcel.faceEdges(f)) {
+            uint32_t twin = dcel.twin(he);
+            if (twin != NONE) {
+                visit(he, twin);
+            }
+            last = he;
+        }
+        return last == NONE || dcel.next(last) == dcel.outerComponent(f);
+    }
+}
+
+template <typename Coord>
+bool BasicDualGraph<Coord>::build(const BasicDCEL<Coord>& dcel, unsigned threads) {
+    size_t faces = dcel.getFaceCount();
+
+    // grau de cada face guardado uma posicao adiante, para a soma de prefixos
+    // virar os offsets no proprio vetor; faces vagas ficam com grau 0. a menor
+    // face cujo ciclo nao fecha interrompe a montagem; depois da primeira, as
+    // demais faces nem sao percorridas, para nao andar o limite de passos em cada
+    std::atomic<uint32_t> broken(UINT32_MAX);
+    offsets.assign(faces + 1, 0);
+    forEachFace(faces, threads, [&](uint32_t f) {
+        if (broken.load(std::memory_order_relaxed) < f) {
+            return;
+        }
+        uint32_t count = 0;
+        if (!walkNeighbors(dcel, f, [&](uint32_t, uint32_t) { count++; })) {
+            uint32_t seen = broken.load(std::memory_order_relaxed);
+            while (f < seen && !broken.compare_exchange_weak(seen, f, std::memory_order_relaxed)) {
+                // seen recebe o valor atual e a comparacao se repete
+            }
+        }
+        offsets[f + 1] = count;
+    });
+    if (broken.load() != UINT32_MAX) {
+        fprintf(stderr, "erro: grafo dual: o ciclo da face %u nao fecha\n", broken.load() + 1);
+        offsets.clear();
+        neighbors.clear();
+        edges.clear();
+        return false;
+    }
+    for (size_t f = 0; f < faces; f++) {
+        offsets[f + 1] += offsets[f];
+    }
+
+    // cada face preenche so o proprio intervalo, com o mesmo percurso da contagem
+    neighbors.resize(offsets[faces]);
+    edges.resize(offsets[faces]);
+    forEachFace(faces, threads, [&](uint32_t f) {
+        uint32_t slot = offsets[f];
+        walkNeighbors(dcel, f, [&](uint32_t he, uint32_t twin) {
+            neighbors[slot] = dcel.incidentFace(twin);
+            edges[slot] = he;
+            slot++;
+        });
+    });
+    return true;
+}
+
+template <typename Coord>
+bool BasicDualGraph<Coord>::write(int fd) const {
+    OutputBuffer out(fd);
+    out.putNumber(getFaceCount());
+    out.put(' ');
+    out.putNumber(getEntryCount());
+    out.put('\n');
+    for (uint32_t offset : offsets) {
+        out.putNumber(offset);
+        out.put('\n');
+    }
+    for (size_t i = 0; i < neighbors.size(); i++) {
+        out.putNumber(neighbors[i] + 1);
+        out.put(' ');
+        out.putNumber(edges[i] + 1);
+        out.put('\n');
+    }
+    return out.flush();
+}
+
+template <typename Coord>
+bool BasicDualGraph<Coord>::save(const char* path) const {
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        fprintf(stderr, "erro: %s: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    DualHeader header = {};
+    memcpy(header.magic, DUAL_MAGIC, sizeof(header.magic));
+    header.version = DUAL_VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.faceCount = getFaceCount();
+    header.entryCount = getEntryCount();
+
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              writeArray(file, offsets) &&
+              writeArray(file, neighbors) &&
+              writeArray(file, edges);
+
+    if (fclose(file) != 0) {
+        ok = false;
+    }
+    if (!ok) {
+        fprintf(stderr, "erro: %s: falha ao gravar grafo dual\n", path);
+    }
+    return ok;
+}
+
+// instancias para cada largura de coordenada (coordinate.h)
+template class BasicDualGraph<int16_t>;
+template class BasicDualGraph<int32_t>;
+template class BasicDualGraph<int64_t>;
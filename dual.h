@@ -0,0 +1,48 @@
+#ifndef DUAL_H
+#define DUAL_H
+
+#include "DCEL.h"
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// grafo dual das faces em CSR (dual.cpp): os vizinhos da face f ocupam
+// [offsets[f], offsets[f + 1]) de neighbors e edges, um por half-edge do ciclo
+// de f que tem twin, na ordem do ciclo a partir de outerComponent. neighbors
+// guarda a face do twin e edges a half-edge de f na aresta compartilhada, entao
+// duas faces com varias arestas em comum aparecem uma vez por aresta. tudo
+// 0-based e na numeracao interna da DCEL. a montagem conta e preenche cada face
+// em paralelo, em O(arestas); instanciado para as mesmas larguras que BasicDCEL
+template <typename Coord>
+class BasicDualGraph {
+public:
+    // recalcula tudo; qualquer edicao posterior da DCEL deixa o grafo velho
+    // (0 usa todos os nucleos). false, com o grafo vazio e a mensagem no stderr,
+    // se o ciclo de alguma face nao volta ao inicio (cadeias que a validacao
+    // aceita com twins na mesma direcao)
+    bool build(const BasicDCEL<Coord>& dcel, unsigned threads = 0);
+
+    size_t getFaceCount() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+    size_t getEntryCount() const { return neighbors.size(); }
+
+    const std::vector<uint32_t>& getOffsets() const { return offsets; }
+    const std::vector<uint32_t>& getNeighbors() const { return neighbors; }
+    const std::vector<uint32_t>& getEdges() const { return edges; }
+    uint32_t degree(uint32_t f) const { return offsets[f + 1] - offsets[f]; }
+
+    // texto: "faces entradas", os offsets um por linha e depois "vizinho aresta"
+    // por entrada, com faces e half-edges 1-based como em printDCEL
+    bool write(int fd) const;
+    // binario: cabecalho de 64 bytes (assinatura DCELDUAL) e os vetores offsets,
+    // neighbors e edges (uint32_t 0-based), cada um alinhado em 64 bytes
+    bool save(const char* path) const;
+
+private:
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> neighbors;
+    std::vector<uint32_t> edges;
+};
+
+using DualGraph = BasicDualGraph<int32_t>;
+
+#endif
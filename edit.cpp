@@ -0,0 +1,436 @@
+#include "DCEL.h"
+#include "geometry.h"
+#include <algorithm>
+
+// edicao incremental: cada operacao refaz so a parte dos criterios de validate()
+// que ela pode violar, olhando apenas as arestas envolvidas
+// - aberta: twins na mesma face ou aresta repetida (insertDiagonal entre faces
+//   distintas ou sobre uma aresta existente, removeEdge que deixaria outra
+//   aresta com as duas half-edges na face unida)
+// - nao planar: laco (insertDiagonal de um vertice a ele mesmo)
+// - superposta: as arestas novas ou movidas contra as que passam pelas mesmas
+//   celulas da grade, com as mesmas excecoes de vertice compartilhado do teste
+//   par a par
+// a grade guarda uma half-edge de cada aresta e acompanha as renumeracoes
+
+template <typename Coord>
+DCELBase::Verdict BasicDCEL<Coord>::prepareEdit(std::initializer_list<uint32_t*> halfEdges,
+                                                uint32_t* vertex) {
+    Verdict verdict = validate();
+    if (verdict != Verdict::VALID) {
+        return verdict;
+    }
+    // as edicoes acrescentam e movem indices no fim dos vetores, na numeracao da entrada
+    if (isReordered()) {
+        for (uint32_t* he : halfEdges) {
+            *he = inputHalfEdge(*he);
+        }
+        if (vertex) {
+            *vertex = inputVertex(*vertex);
+        }
+        restoreInputOrder();
+    }
+    // a grade eh redimensionada quando o numero de arestas dobra
+    if (edgeGrid.empty() || getEdgeCount() > 2 * edgeGrid.capacity()) {
+        buildEdgeGrid();
+    }
+    return Verdict::VALID;
+}
+
+template <typename Coord>
+void BasicDCEL<Coord>::buildEdgeGrid() {
+    Coord minX = 0, minY = 0, maxX = 0, maxY = 0;
+    if (!vertexX.empty()) {
+        minX = *std::min_element(vertexX.begin(), vertexX.end());
+        maxX = *std::max_element(vertexX.begin(), vertexX.end());
+        minY = *std::min_element(vertexY.begin(), vertexY.end());
+        maxY = *std::max_element(vertexY.begin(), vertexY.end());
+    }
+
+    edgeGrid.build(minX, minY, maxX, maxY, getEdgeCount());
+    for (uint32_t he = 0; he < edgeOrigin.size(); he++) {
+        if (edgeTwin[he] > he) {
+            Point p = segmentStart(he), q = segmentEnd(he);
+            edgeGrid.insert(he, p.x, p.y, q.x, q.y);
+        }
+    }
+}
+
+template <typename Coord>
+void BasicDCEL<Coord>::resetEditState() {
+    edgeGrid.clear();
+    freeFaces.clear();
+}
+
+template <typename Coord>
+bool BasicDCEL<Coord>::crossesEdges(uint32_t a, uint32_t b, const Point& pa, const Point& pb) {
+    edgeGrid.query(pa.x, pa.y, pb.x, pb.y, gridHits);
+    for (uint32_t he : gridHits) {
+        uint32_t u = edgeOrigin[he];
+        uint32_t v = destination(he);
+        // arestas com um vertice em comum nunca se testam, como em hasIntersectingFaces
+        if (u == a || u == b || v == a || v == b) {
+            continue;
+        }
+        if (Geometry::segmentsIntersect(pa, pb, vertexPosition(u), vertexPosition(v))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename Coord>
+bool BasicDCEL<Coord>::hasEdge(uint32_t a, uint32_t b) {
+    // uma aresta a-b ja existente passa pelas mesmas celulas
+    Point pa = vertexPosition(a), pb = vertexPosition(b);
+    edgeGrid.query(pa.x, pa.y, pb.x, pb.y, gridHits);
+    for (uint32_t he : gridHits) {
+        uint32_t u = edgeOrigin[he];
+        uint32_t v = destination(he);
+        if ((u == a && v == b) || (u == b && v == a)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename Coord>
+uint32_t BasicDCEL<Coord>::appendHalfEdge(uint32_t originIdx, uint32_t face) {
+    uint32_t he = (uint32_t)edgeOrigin.size();
+    edgeOrigin.push_back(originIdx);
+    edgeTwin.push_back(NONE);
+    edgeFace.push_back(face);
+    edgeNext.push_back(NONE);
+    edgePrev.push_back(NONE);
+    return he;
+}
+
+template <typename Coord>
+void BasicDCEL<Coord>::eraseHalfEdge(uint32_t he) {
+    // a ultima half-edge ocupa o indice liberado; quem apontava para ela passa a
+    // apontar para o novo indice (he ja nao deve ser referenciada por ninguem)
+    uint32_t last = (uint32_t)edgeOrigin.size() - 1;
+    if (he != last) {
+        uint32_t twin = edgeTwin[last];
+        Point p = segmentStart(last), q = segmentEnd(last);
+        edgeGrid.rename(last, he, p.x, p.y, q.x, q.y);
+
+        edgeOrigin[he] = edgeOrigin[last];
+        edgeTwin[he] = twin;
+        edgeFace[he] = edgeFace[last];
+        edgeNext[he] = edgeNext[last];
+        edgePrev[he] = edgePrev[last];
+
+        edgeTwin[twin] = he;
+        edgePrev[edgeNext[he]] = he;
+        edgeNext[edgePrev[he]] = he;
+        if (vertexEdge[edgeOrigin[he]] == last) {
+            vertexEdge[edgeOrigin[he]] = he;
+        }
+        if (faceEdge[edgeFace[he]] == last) {
+            faceEdge[edgeFace[he]] = he;
+        }
+    }
+
+    edgeOrigin.pop_back();
+    edgeTwin.pop_back();
+    edgeFace.pop_back();
+    edgeNext.pop_back();
+    edgePrev.pop_back();
+}
+
+template <typename Coord>
+void BasicDCEL<Coord>::setCycleFace(uint32_t first, uint32_t stop, uint32_t face) {
+    // de first ate a half-edge anterior a stop, seguindo next
+    for (uint32_t he = first; he != stop; he = edgeNext[he]) {
+        edgeFace[he] = face;
+    }
+}
+
+template <typename Coord>
+uint32_t BasicDCEL<Coord>::allocateFace() {
+    if (!freeFaces.empty()) {
+        uint32_t face = freeFaces.back();
+        freeFaces.pop_back();
+        return face;
+    }
+    faceEdge.push_back(NONE);
+    return (uint32_t)faceEdge.size() - 1;
+}
+
+template <typename Coord>
+DCELBase::Verdict BasicDCEL<Coord>::splitEdge(uint32_t he, const Point& position) {
+    Verdict verdict = prepareEdit({&he});
+    if (verdict != Verdict::VALID) {
+        return verdict;
+    }
+
+    uint32_t twin = edgeTwin[he];
+    uint32_t a = edgeOrigin[he];
+    uint32_t b = edgeOrigin[twin];
+    uint32_t w = (uint32_t)vertexX.size();
+
+    // so a geometria muda: o vertice novo nao esta em nenhuma outra aresta
+    Point pa = vertexPosition(a), pb = vertexPosition(b);
+    if (crossesEdges(a, w, pa, position) || crossesEdges(w, b, position, pb)) {
+        return Verdict::OVERLAPPING;
+    }
+
+    vertexX.push_back(position.x);
+    vertexY.push_back(position.y);
+    vertexEdge.push_back(NONE);
+    edgeGrid.remove(he, twin, pa.x, pa.y, pb.x, pb.y);
+
+    // he: a->w e twin: b->w continuam nas mesmas faces, seguidas por
+    // heNext: w->b e twinNext: w->a
+    uint32_t heNext = appendHalfEdge(w, edgeFace[he]);
+    uint32_t twinNext = appendHalfEdge(w, edgeFace[twin]);
+    edgeTwin[he] = twinNext;
+    edgeTwin[twinNext] = he;
+    edgeTwin[twin] = heNext;
+    edgeTwin[heNext] = twin;
+
+    edgeNext[heNext] = edgeNext[he];
+    edgePrev[edgeNext[he]] = heNext;
+    edgeNext[he] = heNext;
+    edgePrev[heNext] = he;
+
+    edgeNext[twinNext] = edgeNext[twin];
+    edgePrev[edgeNext[twin]] = twinNext;
+    edgeNext[twin] = twinNext;
+    edgePrev[twinNext] = twin;
+
+    vertexEdge[w] = heNext;
+    edgeGrid.insert(he, pa.x, pa.y, position.x, position.y);
+    edgeGrid.insert(heNext, position.x, position.y, pb.x, pb.y);
+    return Verdict::VALID;
+}
+
+template <typename Coord>
+DCELBase::Verdict BasicDCEL<Coord>::insertDiagonal(uint32_t from, uint32_t to) {
+    Verdict verdict = prepareEdit({&from, &to});
+    if (verdict != Verdict::VALID) {
+        return verdict;
+    }
+
+    // entre faces diferentes as duas cadeias se juntariam em uma so face,
+    // com os twins novos nela
+    uint32_t face = edgeFace[from];
+    if (edgeFace[to] != face) {
+        return Verdict::OPEN;
+    }
+
+    // aresta repetida tem 3 half-edges (aberta antes de nao planar, como em
+    // validate); laco tem twins na mesma direcao
+    uint32_t u = edgeOrigin[from];
+    uint32_t v = edgeOrigin[to];
+    if (u == v) {
+        return Verdict::NON_PLANAR;
+    }
+    if (hasEdge(u, v)) {
+        return Verdict::OPEN;
+    }
+    if (crossesEdges(u, v, vertexPosition(u), vertexPosition(v))) {
+        return Verdict::OVERLAPPING;
+    }
+
+    // a face se divide em from..prev(to), fechada por toU: v->u, e em
+    // to..prev(from), fechada por toV: u->v; percorrer as duas partes ao mesmo
+    // tempo acha a menor sem andar pela maior
+    bool fromPartSmaller = false;
+    for (uint32_t a = from, b = to;;) {
+        a = edgeNext[a];
+        if (a == to) {
+            fromPartSmaller = true;
+            break;
+        }
+        b = edgeNext[b];
+        if (b == from) {
+            break;
+        }
+    }
+
+    uint32_t newFace = allocateFace();
+    uint32_t prevFrom = edgePrev[from];
+    uint32_t prevTo = edgePrev[to];
+    uint32_t toU = appendHalfEdge(v, fromPartSmaller ? newFace : face);
+    uint32_t toV = appendHalfEdge(u, fromPartSmaller ? face : newFace);
+    edgeTwin[toU] = toV;
+    edgeTwin[toV] = toU;
+
+    edgeNext[prevTo] = toU;
+    edgePrev[toU] = prevTo;
+    edgeNext[toU] = from;
+    edgePrev[from] = toU;
+
+    edgeNext[prevFrom] = toV;
+    edgePrev[toV] = prevFrom;
+    edgeNext[toV] = to;
+    edgePrev[to] = toV;
+
+    if (fromPartSmaller) {
+        setCycleFace(from, toU, newFace);
+        faceEdge[newFace] = toU;
+    } else {
+        setCycleFace(to, toV, newFace);
+        faceEdge[newFace] = toV;
+    }
+    if (edgeFace[faceEdge[face]] != face) {
+        faceEdge[face] = fromPartSmaller ? toV : toU;
+    }
+
+    Point pu = vertexPosition(u), pv = vertexPosition(v);
+    edgeGrid.insert(toV, pu.x, pu.y, pv.x, pv.y);
+    return Verdict::VALID;
+}
+
+template <typename Coord>
+DCELBase::Verdict BasicDCEL<Coord>::removeEdge(uint32_t he) {
+    Verdict verdict = prepareEdit({&he});
+    if (verdict != Verdict::VALID) {
+        return verdict;
+    }
+
+    uint32_t twin = edgeTwin[he];
+
+    // a face com menos half-edges eh absorvida pela outra
+    uint32_t absorbed = he;
+    for (uint32_t a = he, b = twin;;) {
+        a = edgeNext[a];
+        if (a == he) {
+            break;
+        }
+        b = edgeNext[b];
+        if (b == twin) {
+            absorbed = twin;
+            break;
+        }
+    }
+    uint32_t kept = edgeTwin[absorbed];
+    uint32_t removedFace = edgeFace[absorbed];
+    uint32_t keptFace = edgeFace[kept];
+
+    // outra aresta entre as duas faces ficaria com os twins na face unida
+    // (inclusive a aresta que sobra em um vertice de grau 2)
+    for (uint32_t h = edgeNext[absorbed]; h != absorbed; h = edgeNext[h]) {
+        if (edgeFace[edgeTwin[h]] == keptFace) {
+            return Verdict::OPEN;
+        }
+    }
+
+    uint32_t u = edgeOrigin[he];
+    uint32_t v = edgeOrigin[twin];
+    uint32_t heNext = edgeNext[he], hePrev = edgePrev[he];
+    uint32_t twinNext = edgeNext[twin], twinPrev = edgePrev[twin];
+
+    setCycleFace(edgeNext[absorbed], absorbed, keptFace);
+    faceEdge[removedFace] = NONE;
+    freeFaces.push_back(removedFace);
+    if (faceEdge[keptFace] == kept) {
+        faceEdge[keptFace] = edgeNext[kept];
+    }
+    if (vertexEdge[u] == he) {
+        vertexEdge[u] = twinNext;
+    }
+    if (vertexEdge[v] == twin) {
+        vertexEdge[v] = heNext;
+    }
+
+    edgeNext[hePrev] = twinNext;
+    edgePrev[twinNext] = hePrev;
+    edgeNext[twinPrev] = heNext;
+    edgePrev[heNext] = twinPrev;
+
+    Point pu = vertexPosition(u), pv = vertexPosition(v);
+    edgeGrid.remove(he, twin, pu.x, pu.y, pv.x, pv.y);
+
+    // o maior indice sai primeiro, para a outra half-edge removida nao ser movida
+    edgeTwin[he] = edgeTwin[twin] = NONE;
+    eraseHalfEdge(std::max(he, twin));
+    eraseHalfEdge(std::min(he, twin));
+    return Verdict::VALID;
+}
+
+template <typename Coord>
+DCELBase::Verdict BasicDCEL<Coord>::moveVertex(uint32_t v, const Point& position) {
+    Verdict verdict = prepareEdit({}, &v);
+    if (verdict != Verdict::VALID) {
+        return verdict;
+    }
+
+    // arestas de v: todas passam pela celula de v
+    Point old = vertexPosition(v);
+    edgeGrid.query(old.x, old.y, old.x, old.y, gridHits);
+    std::vector<uint32_t> incident;
+    for (uint32_t he : gridHits) {
+        if (edgeOrigin[he] == v || destination(he) == v) {
+            incident.push_back(he);
+        }
+    }
+
+    // a topologia nao muda; so as arestas de v se movem
+    for (uint32_t he : incident) {
+        uint32_t other = edgeOrigin[he] == v ? destination(he) : edgeOrigin[he];
+        if (crossesEdges(v, other, position, vertexPosition(other))) {
+            return Verdict::OVERLAPPING;
+        }
+    }
+
+    for (uint32_t he : incident) {
+        Point p = segmentStart(he), q = segmentEnd(he);
+        edgeGrid.remove(he, edgeTwin[he], p.x, p.y, q.x, q.y);
+    }
+    vertexX[v] = position.x;
+    vertexY[v] = position.y;
+    for (uint32_t he : incident) {
+        Point p = segmentStart(he), q = segmentEnd(he);
+        edgeGrid.insert(he, p.x, p.y, q.x, q.y);
+    }
+    return Verdict::VALID;
+}
+
+template <typename Coord>
+void BasicDCEL<Coord>::compact() {
+    // a ultima face viva ocupa cada vaga, da menor para a maior
+    std::sort(freeFaces.begin(), freeFaces.end());
+    for (uint32_t vacant : freeFaces) {
+        while (!faceEdge.empty() && faceEdge[faceEdge.size() - 1] == NONE) {
+            faceEdge.pop_back();
+        }
+        if (vacant >= faceEdge.size()) {
+            break;
+        }
+
+        uint32_t last = (uint32_t)faceEdge.size() - 1;
+        for (uint32_t he : faceEdges(last)) {
+            edgeFace[he] = vacant;
+        }
+        faceEdge[vacant] = faceEdge[last];
+        faceEdge.pop_back();
+    }
+    freeFaces.clear();
+}
+
+// instancias para cada largura de coordenada (coordinate.h)
+#define INSTANTIATE_EDIT(Coord)                                                               \
+    template DCELBase::Verdict BasicDCEL<Coord>::prepareEdit(std::initializer_list<uint32_t*>, \
+                                                             uint32_t*);                    \
+    template void BasicDCEL<Coord>::buildEdgeGrid();                                        \
+    template void BasicDCEL<Coord>::resetEditState();                                       \
+    template bool BasicDCEL<Coord>::crossesEdges(uint32_t, uint32_t, const BasicPoint<Coord>&, \
+                                                 const BasicPoint<Coord>&);                  \
+    template bool BasicDCEL<Coord>::hasEdge(uint32_t, uint32_t);                            \
+    template uint32_t BasicDCEL<Coord>::appendHalfEdge(uint32_t, uint32_t);                 \
+    template void BasicDCEL<Coord>::eraseHalfEdge(uint32_t);                                \
+    template void BasicDCEL<Coord>::setCycleFace(uint32_t, uint32_t, uint32_t);             \
+    template uint32_t BasicDCEL<Coord>::allocateFace();                                     \
+    template DCELBase::Verdict BasicDCEL<Coord>::splitEdge(uint32_t, const BasicPoint<Coord>&); \
+    template DCELBase::Verdict BasicDCEL<Coord>::insertDiagonal(uint32_t, uint32_t);        \
+    template DCELBase::Verdict BasicDCEL<Coord>::removeEdge(uint32_t);                      \
+    template DCELBase::Verdict BasicDCEL<Coord>::moveVertex(uint32_t, const BasicPoint<Coord>&); \
+    template void BasicDCEL<Coord>::compact();
+
+INSTANTIATE_EDIT(int16_t)
+INSTANTIATE_EDIT(int32_t)
+INSTANTIATE_EDIT(int64_t)
+#undef INSTANTIATE_EDIT
@@ -1,21 +1,33 @@
 #include "geometry.h"
+#include "stats.h"
 #include <algorithm>
+#include <type_traits>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define GEOMETRY_AVX2 1
+#endif
 
 namespace Geometry {
-    Orientation orientation(const Point& a, const Point& b, const Point& c) {
-        long long val = (long long)(b.y - a.y) * (c.x - b.x) - 
-                       (long long)(b.x - a.x) * (c.y - b.y);
+    template <typename Coord>
+    Orientation orientation(const BasicPoint<Coord>& a, const BasicPoint<Coord>& b,
+                            const BasicPoint<Coord>& c) {
+        using Wide = typename CoordinateTraits<Coord>::Wide;
+        Stats::tick(Stats::PREDICATES);
+        Wide val = ((Wide)b.y - a.y) * ((Wide)c.x - b.x) -
+                   ((Wide)b.x - a.x) * ((Wide)c.y - b.y);
         if (val == 0) return Orientation::COLINEAR;
         return (val > 0) ? Orientation::ANTIHORARIO : Orientation::HORARIO;
     }
     
-    bool onSegment(const Point& p, const Point& q, const Point& r) {
+    template <typename Coord>
+    bool onSegment(const BasicPoint<Coord>& p, const BasicPoint<Coord>& q, const BasicPoint<Coord>& r) {
         return (q.x <= std::max(p.x, r.x) && q.x >= std::min(p.x, r.x) &&
                 q.y <= std::max(p.y, r.y) && q.y >= std::min(p.y, r.y));
     }
     
-    bool segmentsIntersect(const Point& p1, const Point& q1, 
-                          const Point& p2, const Point& q2) {
+    template <typename Coord>
+    bool segmentsIntersect(const BasicPoint<Coord>& p1, const BasicPoint<Coord>& q1,
+                           const BasicPoint<Coord>& p2, const BasicPoint<Coord>& q2) {
         if (p1 == p2 || p1 == q2 || q1 == p2 || q1 == q2) {
             return false;
         }
@@ -36,4 +48,225 @@ namespace Geometry {
         
         return false;
     }
-} 
\ No newline at end of file
+
+    template <typename Coord>
+    void SegmentPairs<Coord>::clear() {
+        for (std::vector<Coord>* column : {&p1x, &p1y, &q1x, &q1y, &p2x, &p2y, &q2x, &q2y}) {
+            column->clear();
+        }
+    }
+
+    template <typename Coord>
+    void SegmentPairs<Coord>::resize(size_t count) {
+        for (std::vector<Coord>* column : {&p1x, &p1y, &q1x, &q1y, &p2x, &p2y, &q2x, &q2y}) {
+            column->resize(count);
+        }
+    }
+
+    template <typename Coord>
+    void SegmentPairs<Coord>::add(const Point& p1, const Point& q1, const Point& p2, const Point& q2) {
+        p1x.push_back(p1.x);
+        p1y.push_back(p1.y);
+        q1x.push_back(q1.x);
+        q1y.push_back(q1.y);
+        p2x.push_back(p2.x);
+        p2y.push_back(p2.y);
+        q2x.push_back(q2.x);
+        q2y.push_back(q2.y);
+    }
+
+    namespace {
+        template <typename Coord>
+        bool pairIntersects(const SegmentPairs<Coord>& pairs, size_t i) {
+            using Point = BasicPoint<Coord>;
+            return segmentsIntersect(Point(pairs.p1x[i], pairs.p1y[i]), Point(pairs.q1x[i], pairs.q1y[i]),
+                                     Point(pairs.p2x[i], pairs.p2y[i]), Point(pairs.q2x[i], pairs.q2y[i]));
+        }
+
+        template <typename Coord>
+        void intersectScalar(const SegmentPairs<Coord>& pairs, size_t begin, size_t count, uint64_t* hits) {
+            for (size_t i = begin; i < count; i++) {
+                if (pairIntersects(pairs, i)) {
+                    hits[i / 64] |= uint64_t(1) << (i % 64);
+                }
+            }
+        }
+
+#ifdef GEOMETRY_AVX2
+        // os dois kernels seguem o mesmo roteiro: o caso geral (orientacoes
+        // diferentes dos dois lados) sai direto dos sinais e pares com algum ponto
+        // colinear, raros, vao para a versao escalar, que decide com onSegment.
+        // dentro do intervalo de cada largura as diferencas e os produtos abaixo
+        // sao exatos, entao os sinais sao os mesmos da versao escalar
+
+        // int32: 4 lanes, diferencas em 32 bits e produtos em 64
+        __attribute__((target("avx2")))
+        __m256i orientation4(__m128i ax, __m128i ay, __m128i bx, __m128i by,
+                             __m128i cx, __m128i cy) {
+            __m256i left = _mm256_mul_epi32(_mm256_cvtepi32_epi64(_mm_sub_epi32(by, ay)),
+                                            _mm256_cvtepi32_epi64(_mm_sub_epi32(cx, bx)));
+            __m256i right = _mm256_mul_epi32(_mm256_cvtepi32_epi64(_mm_sub_epi32(bx, ax)),
+                                             _mm256_cvtepi32_epi64(_mm_sub_epi32(cy, by)));
+            return _mm256_sub_epi64(left, right);
+        }
+
+        __attribute__((target("avx2")))
+        __m128i load4(const std::vector<int32_t>& column, size_t i) {
+            return _mm_loadu_si128((const __m128i*)(column.data() + i));
+        }
+
+        __attribute__((target("avx2")))
+        __m128i samePoint4(__m128i ax, __m128i ay, __m128i bx, __m128i by) {
+            return _mm_and_si128(_mm_cmpeq_epi32(ax, bx), _mm_cmpeq_epi32(ay, by));
+        }
+
+        __attribute__((target("avx2")))
+        void intersectAvx2(const SegmentPairs<int32_t>& pairs, size_t count, uint64_t* hits) {
+            const __m256i zero = _mm256_setzero_si256();
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                __m128i p1x = load4(pairs.p1x, i), p1y = load4(pairs.p1y, i);
+                __m128i q1x = load4(pairs.q1x, i), q1y = load4(pairs.q1y, i);
+                __m128i p2x = load4(pairs.p2x, i), p2y = load4(pairs.p2y, i);
+                __m128i q2x = load4(pairs.q2x, i), q2y = load4(pairs.q2y, i);
+
+                // extremos coincidentes nunca contam como intersecao
+                __m128i shared = _mm_or_si128(
+                    _mm_or_si128(samePoint4(p1x, p1y, p2x, p2y), samePoint4(p1x, p1y, q2x, q2y)),
+                    _mm_or_si128(samePoint4(q1x, q1y, p2x, p2y), samePoint4(q1x, q1y, q2x, q2y)));
+                int sharedMask = _mm_movemask_ps(_mm_castsi128_ps(shared));
+
+                __m256i o1 = orientation4(p1x, p1y, q1x, q1y, p2x, p2y);
+                __m256i o2 = orientation4(p1x, p1y, q1x, q1y, q2x, q2y);
+                __m256i o3 = orientation4(p2x, p2y, q2x, q2y, p1x, p1y);
+                __m256i o4 = orientation4(p2x, p2y, q2x, q2y, q1x, q1y);
+
+                // orientacoes diferentes: difere o sinal positivo ou o zero
+                __m256i z1 = _mm256_cmpeq_epi64(o1, zero), z2 = _mm256_cmpeq_epi64(o2, zero);
+                __m256i z3 = _mm256_cmpeq_epi64(o3, zero), z4 = _mm256_cmpeq_epi64(o4, zero);
+                __m256i differ12 = _mm256_or_si256(
+                    _mm256_xor_si256(_mm256_cmpgt_epi64(o1, zero), _mm256_cmpgt_epi64(o2, zero)),
+                    _mm256_xor_si256(z1, z2));
+                __m256i differ34 = _mm256_or_si256(
+                    _mm256_xor_si256(_mm256_cmpgt_epi64(o3, zero), _mm256_cmpgt_epi64(o4, zero)),
+                    _mm256_xor_si256(z3, z4));
+                int generalMask = _mm256_movemask_pd(_mm256_castsi256_pd(
+                    _mm256_and_si256(differ12, differ34)));
+                int colinearMask = _mm256_movemask_pd(_mm256_castsi256_pd(
+                    _mm256_or_si256(_mm256_or_si256(z1, z2), _mm256_or_si256(z3, z4))));
+
+                int hitMask = generalMask & ~sharedMask;
+                int scalarMask = colinearMask & ~generalMask & ~sharedMask;
+                Stats::tick(Stats::PREDICATES, 16);
+                for (int lane = 0; lane < 4; lane++) {
+                    if ((scalarMask >> lane) & 1) {
+                        hitMask |= (int)pairIntersects(pairs, i + lane) << lane;
+                    }
+                }
+                // i eh multiplo de 4, entao as 4 lanes ficam na mesma palavra
+                hits[i / 64] |= (uint64_t)hitMask << (i % 64);
+            }
+            intersectScalar(pairs, i, count, hits);
+        }
+
+        // int16: 8 lanes, tudo em 32 bits
+        __attribute__((target("avx2")))
+        __m256i orientation8(__m256i ax, __m256i ay, __m256i bx, __m256i by,
+                             __m256i cx, __m256i cy) {
+            __m256i left = _mm256_mullo_epi32(_mm256_sub_epi32(by, ay), _mm256_sub_epi32(cx, bx));
+            __m256i right = _mm256_mullo_epi32(_mm256_sub_epi32(bx, ax), _mm256_sub_epi32(cy, by));
+            return _mm256_sub_epi32(left, right);
+        }
+
+        __attribute__((target("avx2")))
+        __m256i load8(const std::vector<int16_t>& column, size_t i) {
+            return _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(column.data() + i)));
+        }
+
+        __attribute__((target("avx2")))
+        __m256i samePoint8(__m256i ax, __m256i ay, __m256i bx, __m256i by) {
+            return _mm256_and_si256(_mm256_cmpeq_epi32(ax, bx), _mm256_cmpeq_epi32(ay, by));
+        }
+
+        __attribute__((target("avx2")))
+        void intersectAvx2(const SegmentPairs<int16_t>& pairs, size_t count, uint64_t* hits) {
+            const __m256i zero = _mm256_setzero_si256();
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                __m256i p1x = load8(pairs.p1x, i), p1y = load8(pairs.p1y, i);
+                __m256i q1x = load8(pairs.q1x, i), q1y = load8(pairs.q1y, i);
+                __m256i p2x = load8(pairs.p2x, i), p2y = load8(pairs.p2y, i);
+                __m256i q2x = load8(pairs.q2x, i), q2y = load8(pairs.q2y, i);
+
+                __m256i shared = _mm256_or_si256(
+                    _mm256_or_si256(samePoint8(p1x, p1y, p2x, p2y), samePoint8(p1x, p1y, q2x, q2y)),
+                    _mm256_or_si256(samePoint8(q1x, q1y, p2x, p2y), samePoint8(q1x, q1y, q2x, q2y)));
+                int sharedMask = _mm256_movemask_ps(_mm256_castsi256_ps(shared));
+
+                __m256i o1 = orientation8(p1x, p1y, q1x, q1y, p2x, p2y);
+                __m256i o2 = orientation8(p1x, p1y, q1x, q1y, q2x, q2y);
+                __m256i o3 = orientation8(p2x, p2y, q2x, q2y, p1x, p1y);
+                __m256i o4 = orientation8(p2x, p2y, q2x, q2y, q1x, q1y);
+
+                __m256i z1 = _mm256_cmpeq_epi32(o1, zero), z2 = _mm256_cmpeq_epi32(o2, zero);
+                __m256i z3 = _mm256_cmpeq_epi32(o3, zero), z4 = _mm256_cmpeq_epi32(o4, zero);
+                __m256i differ12 = _mm256_or_si256(
+                    _mm256_xor_si256(_mm256_cmpgt_epi32(o1, zero), _mm256_cmpgt_epi32(o2, zero)),
+                    _mm256_xor_si256(z1, z2));
+                __m256i differ34 = _mm256_or_si256(
+                    _mm256_xor_si256(_mm256_cmpgt_epi32(o3, zero), _mm256_cmpgt_epi32(o4, zero)),
+                    _mm256_xor_si256(z3, z4));
+                int generalMask = _mm256_movemask_ps(_mm256_castsi256_ps(
+                    _mm256_and_si256(differ12, differ34)));
+                int colinearMask = _mm256_movemask_ps(_mm256_castsi256_ps(
+                    _mm256_or_si256(_mm256_or_si256(z1, z2), _mm256_or_si256(z3, z4))));
+
+                int hitMask = generalMask & ~sharedMask;
+                int scalarMask = colinearMask & ~generalMask & ~sharedMask;
+                Stats::tick(Stats::PREDICATES, 32);
+                for (int lane = 0; lane < 8; lane++) {
+                    if ((scalarMask >> lane) & 1) {
+                        hitMask |= (int)pairIntersects(pairs, i + lane) << lane;
+                    }
+                }
+                hits[i / 64] |= (uint64_t)hitMask << (i % 64);
+            }
+            intersectScalar(pairs, i, count, hits);
+        }
+#endif
+    }
+
+    template <typename Coord>
+    void segmentsIntersectBatch(const SegmentPairs<Coord>& pairs, size_t count,
+                                std::vector<uint64_t>& hits) {
+        hits.assign((count + 63) / 64, 0);
+#ifdef GEOMETRY_AVX2
+        // int64 precisa de produtos de 128 bits, sem equivalente vetorial
+        if constexpr (!std::is_same<Coord, int64_t>::value) {
+            static const bool avx2 = __builtin_cpu_supports("avx2");
+            if (avx2) {
+                intersectAvx2(pairs, count, hits.data());
+                return;
+            }
+        }
+#endif
+        intersectScalar(pairs, 0, count, hits.data());
+    }
+
+    // instancias para cada largura de coordenada (coordinate.h)
+#define INSTANTIATE_GEOMETRY(Coord)                                                          \
+    template Orientation orientation(const BasicPoint<Coord>&, const BasicPoint<Coord>&,    \
+                                     const BasicPoint<Coord>&);                              \
+    template bool onSegment(const BasicPoint<Coord>&, const BasicPoint<Coord>&,             \
+                            const BasicPoint<Coord>&);                                       \
+    template bool segmentsIntersect(const BasicPoint<Coord>&, const BasicPoint<Coord>&,     \
+                                    const BasicPoint<Coord>&, const BasicPoint<Coord>&);     \
+    template struct SegmentPairs<Coord>;                                                     \
+    template void segmentsIntersectBatch(const SegmentPairs<Coord>&, size_t,                \
+                                         std::vector<uint64_t>&);
+
+    INSTANTIATE_GEOMETRY(int16_t)
+    INSTANTIATE_GEOMETRY(int32_t)
+    INSTANTIATE_GEOMETRY(int64_t)
+#undef INSTANTIATE_GEOMETRY
+}
@@ -2,6 +2,9 @@
 #define GEOMETRY_H
 
 #include "DCEL.h"  // for Point structure
+#include <vector>
+#include <cstddef>
+#include <cstdint>
 
 namespace Geometry {
     enum class Orientation {
@@ -10,12 +13,47 @@ namespace Geometry {
         ANTIHORARIO  // sentido anti-horario (counter-clockwise)
     };
 
-    // retorna orientacao de tres pontos
-    Orientation orientation(const Point& a, const Point& b, const Point& c);
+    // retorna orientacao de tres pontos, com o determinante calculado em
+    // CoordinateTraits<Coord>::Wide (exato dentro do intervalo da largura)
+    template <typename Coord>
+    Orientation orientation(const BasicPoint<Coord>& a, const BasicPoint<Coord>& b,
+                            const BasicPoint<Coord>& c);
     
-    bool onSegment(const Point& p, const Point& q, const Point& r);
+    template <typename Coord>
+    bool onSegment(const BasicPoint<Coord>& p, const BasicPoint<Coord>& q, const BasicPoint<Coord>& r);
     
-    bool segmentsIntersect(const Point& p1, const Point& q1, const Point& p2, const Point& q2);
+    template <typename Coord>
+    bool segmentsIntersect(const BasicPoint<Coord>& p1, const BasicPoint<Coord>& q1,
+                           const BasicPoint<Coord>& p2, const BasicPoint<Coord>& q2);
+
+    // pares de segmentos candidatos em colunas (SoA), para o teste em lote
+    template <typename Coord>
+    struct SegmentPairs {
+        using Point = BasicPoint<Coord>;
+
+        std::vector<Coord> p1x, p1y, q1x, q1y;
+        std::vector<Coord> p2x, p2y, q2x, q2y;
+
+        size_t size() const { return p1x.size(); }
+        void clear();
+        // redimensiona as colunas, para preencher os pares por indice e testar so os
+        // primeiros com o count de segmentsIntersectBatch
+        void resize(size_t count);
+        void add(const Point& p1, const Point& q1, const Point& p2, const Point& q2);
+    };
+
+    // segmentsIntersect dos count primeiros pares, com a mesma aritmetica inteira:
+    // o bit i % 64 de hits[i / 64] fica ligado quando o par i se intersecta. usa
+    // AVX2 quando o processador tem (8 pares por vez com int16, 4 com int32) e o
+    // laco escalar caso contrario ou com int64
+    template <typename Coord>
+    void segmentsIntersectBatch(const SegmentPairs<Coord>& pairs, size_t count,
+                                std::vector<uint64_t>& hits);
+
+    template <typename Coord>
+    void segmentsIntersectBatch(const SegmentPairs<Coord>& pairs, std::vector<uint64_t>& hits) {
+        segmentsIntersectBatch(pairs, pairs.size(), hits);
+    }
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,122 @@
+#include "grid.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // limite de celulas, para malhas enormes nao gastarem memoria so com a grade
+    const long long MAX_CELLS = 1LL << 22;
+}
+
+void SegmentGrid::build(int64_t minX, int64_t minY, int64_t maxX, int64_t maxY, size_t segments) {
+    originX = minX;
+    originY = minY;
+    // coordenadas de 64 bits ficam em (-2^62, 2^62), entao largura e altura cabem
+    long long width = (long long)(maxX - minX) + 1;
+    long long height = (long long)(maxY - minY) + 1;
+
+    // celulas quadradas com cerca de 2 segmentos cada
+    long long target = std::min(std::max((long long)(segments / 2), 1LL), MAX_CELLS);
+    double side = std::ceil(std::sqrt((double)width * (double)height / (double)target));
+    cellSize = std::max((long long)std::min(side, (double)std::max(width, height)), 1LL);
+    columns = width / cellSize + (width % cellSize != 0);
+    rows = height / cellSize + (height % cellSize != 0);
+    sizedFor = segments;
+
+    cells.clear();
+    cells.resize((size_t)(columns * rows));
+}
+
+void SegmentGrid::clear() {
+    std::vector<std::vector<uint32_t>>().swap(cells);
+    columns = rows = 0;
+    sizedFor = 0;
+}
+
+long long SegmentGrid::rowOf(int64_t y) const {
+    long long offset = (long long)y - originY;
+    if (offset < 0) return 0;
+    return std::min(offset / cellSize, rows - 1);
+}
+
+long long SegmentGrid::columnOf(double x) const {
+    double column = std::floor((x - (double)originX) / (double)cellSize);
+    if (column < 0) return 0;
+    return column >= (double)(columns - 1) ? columns - 1 : (long long)column;
+}
+
+template <typename Visit>
+void SegmentGrid::forEachCell(int64_t x0, int64_t y0, int64_t x1, int64_t y1, Visit visit) const {
+    if (y0 > y1) {
+        std::swap(x0, x1);
+        std::swap(y0, y1);
+    }
+
+    // em cada linha da grade, o trecho do segmento dentro da faixa (com folga de 1
+    // em y e de uma coluna de cada lado, que cobre o arredondamento em double);
+    // a primeira e a ultima faixa se estendem ate o infinito
+    long long lastRow = rowOf(y1);
+    for (long long row = rowOf(y0); row <= lastRow; row++) {
+        double low = y0, high = y1;
+        if (row > 0) {
+            low = std::max(low, (double)(originY + row * cellSize) - 1.0);
+        }
+        if (row < rows - 1) {
+            high = std::min(high, (double)(originY + (row + 1) * cellSize) + 1.0);
+        }
+
+        double xLow = x0, xHigh = x1;
+        if (y0 != y1) {
+            double slope = (double)((long long)x1 - x0) / (double)((long long)y1 - y0);
+            xLow = x0 + (low - y0) * slope;
+            xHigh = x0 + (high - y0) * slope;
+        }
+        if (xLow > xHigh) {
+            std::swap(xLow, xHigh);
+        }
+
+        long long first = std::max(columnOf(xLow) - 1, 0LL);
+        long long last = std::min(columnOf(xHigh) + 1, columns - 1);
+        for (long long column = first; column <= last; column++) {
+            visit((size_t)(row * columns + column));
+        }
+    }
+}
+
+void SegmentGrid::insert(uint32_t id, int64_t x0, int64_t y0, int64_t x1, int64_t y1) {
+    forEachCell(x0, y0, x1, y1, [&](size_t cell) {
+        cells[cell].push_back(id);
+    });
+}
+
+void SegmentGrid::remove(uint32_t first, uint32_t second, int64_t x0, int64_t y0, int64_t x1, int64_t y1) {
+    forEachCell(x0, y0, x1, y1, [&](size_t cell) {
+        std::vector<uint32_t>& ids = cells[cell];
+        for (size_t i = 0; i < ids.size(); i++) {
+            if (ids[i] == first || ids[i] == second) {
+                ids[i] = ids.back();
+                ids.pop_back();
+                break;
+            }
+        }
+    });
+}
+
+void SegmentGrid::rename(uint32_t from, uint32_t to, int64_t x0, int64_t y0, int64_t x1, int64_t y1) {
+    forEachCell(x0, y0, x1, y1, [&](size_t cell) {
+        for (uint32_t& id : cells[cell]) {
+            if (id == from) {
+                id = to;
+                break;
+            }
+        }
+    });
+}
+
+void SegmentGrid::query(int64_t x0, int64_t y0, int64_t x1, int64_t y1, std::vector<uint32_t>& ids) const {
+    ids.clear();
+    forEachCell(x0, y0, x1, y1, [&](size_t cell) {
+        ids.insert(ids.end(), cells[cell].begin(), cells[cell].end());
+    });
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+}
@@ -0,0 +1,44 @@
+#ifndef GRID_H
+#define GRID_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// grade uniforme de segmentos para consultas locais: cada segmento fica em todas
+// as celulas que atravessa (com uma celula de folga), entao dois segmentos que se
+// tocam sempre dividem ao menos uma celula; pontos fora do retangulo da grade
+// caem nas celulas da borda. as coordenadas sao de 64 bits para servir a todas as
+// larguras de BasicDCEL
+class SegmentGrid {
+public:
+    // retangulo coberto e numero esperado de segmentos (cerca de 2 por celula)
+    void build(int64_t minX, int64_t minY, int64_t maxX, int64_t maxY, size_t segments);
+    void clear();
+    bool empty() const { return cells.empty(); }
+    // numero de segmentos para o qual a grade foi dimensionada
+    size_t capacity() const { return sizedFor; }
+
+    void insert(uint32_t id, int64_t x0, int64_t y0, int64_t x1, int64_t y1);
+    // remove a entrada first ou second (por exemplo, as duas half-edges de uma aresta)
+    void remove(uint32_t first, uint32_t second, int64_t x0, int64_t y0, int64_t x1, int64_t y1);
+    // troca o id de um segmento que continua no mesmo lugar
+    void rename(uint32_t from, uint32_t to, int64_t x0, int64_t y0, int64_t x1, int64_t y1);
+    // ids das celulas atravessadas pelo segmento, ordenados e sem repeticao
+    void query(int64_t x0, int64_t y0, int64_t x1, int64_t y1, std::vector<uint32_t>& ids) const;
+
+private:
+    long long originX = 0, originY = 0;
+    long long cellSize = 1;
+    long long columns = 0, rows = 0;
+    size_t sizedFor = 0;
+    std::vector<std::vector<uint32_t>> cells;
+
+    long long rowOf(int64_t y) const;
+    long long columnOf(double x) const;
+
+    template <typename Visit>
+    void forEachCell(int64_t x0, int64_t y0, int64_t x1, int64_t y1, Visit visit) const;
+};
+
+#endif
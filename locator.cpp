@@ -0,0 +1,468 @@
+#include "locator.h"
+#include "geometry.h"
+#include <cstdio>
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <thread>
+
+namespace {
+    const uint32_t NONE = DCELBase::NONE;
+
+    // ordem lexicografica: x e, no empate, y
+    template <typename Coord>
+    bool lexLess(const BasicPoint<Coord>& a, const BasicPoint<Coord>& b) {
+        return a.x < b.x || (a.x == b.x && a.y < b.y);
+    }
+
+    // semente fixa: a estrutura (e o tempo de consulta) nao varia entre execucoes
+    const unsigned INSERTION_SEED = 0x5eed;
+
+    // abaixo disso as consultas em lote rodam na thread atual
+    const size_t MIN_BATCH_PER_THREAD = 4096;
+
+    // rodadas com menos segmentos que isso nao sao reordenadas
+    const size_t MIN_SORTED_ROUND = 64;
+
+    // intercala os bits de x e y (deslocados para sem sinal): pontos proximos no
+    // plano ficam, em geral, proximos na ordem de Morton. de coordenadas de 64
+    // bits so entram os 32 bits mais altos
+    template <typename Coord>
+    uint64_t mortonKey(const BasicPoint<Coord>& point) {
+        auto spread = [](uint64_t v) {
+            v &= 0xffffffffull;
+            v = (v | (v << 16)) & 0x0000ffff0000ffffull;
+            v = (v | (v << 8)) & 0x00ff00ff00ff00ffull;
+            v = (v | (v << 4)) & 0x0f0f0f0f0f0f0f0full;
+            v = (v | (v << 2)) & 0x3333333333333333ull;
+            v = (v | (v << 1)) & 0x5555555555555555ull;
+            return v;
+        };
+        auto offset = [](Coord c) {
+            uint64_t v = (uint64_t)((int64_t)c - std::numeric_limits<Coord>::min());
+            return sizeof(Coord) > 4 ? v >> 32 : v;
+        };
+        uint64_t x = offset(point.x);
+        uint64_t y = offset(point.y);
+        return spread(x) | (spread(y) << 1);
+    }
+}
+
+template <typename Coord>
+bool BasicPointLocator<Coord>::isAbove(const Point& point, uint32_t segment,
+                                       bool& collinear) const {
+    // HORARIO: o ponto esta a esquerda de left->right, ou seja, acima
+    Geometry::Orientation o = Geometry::orientation(points[segments[segment].left],
+                                                    points[segments[segment].right], point);
+    collinear = o == Geometry::Orientation::COLINEAR;
+    return o == Geometry::Orientation::HORARIO;
+}
+
+template <typename Coord>
+uint32_t BasicPointLocator<Coord>::newTrapezoid(uint32_t top, uint32_t bottom, uint32_t leftp,
+                                                uint32_t rightp) {
+    trapezoids.push_back({top, bottom, leftp, rightp, NONE, NONE, NONE, NONE, NONE});
+    return (uint32_t)trapezoids.size() - 1;
+}
+
+template <typename Coord>
+uint32_t BasicPointLocator<Coord>::leafOf(uint32_t trapezoid) {
+    if (trapezoids[trapezoid].node == NONE) {
+        nodes.push_back({NodeType::LEAF, trapezoid, NONE, NONE});
+        trapezoids[trapezoid].node = (uint32_t)nodes.size() - 1;
+    }
+    return trapezoids[trapezoid].node;
+}
+
+template <typename Coord>
+void BasicPointLocator<Coord>::replaceLeft(uint32_t trapezoid, uint32_t from, uint32_t to) {
+    if (trapezoid == NONE) return;
+    if (trapezoids[trapezoid].upperLeft == from) trapezoids[trapezoid].upperLeft = to;
+    if (trapezoids[trapezoid].lowerLeft == from) trapezoids[trapezoid].lowerLeft = to;
+}
+
+template <typename Coord>
+void BasicPointLocator<Coord>::replaceRight(uint32_t trapezoid, uint32_t from, uint32_t to) {
+    if (trapezoid == NONE) return;
+    if (trapezoids[trapezoid].upperRight == from) trapezoids[trapezoid].upperRight = to;
+    if (trapezoids[trapezoid].lowerRight == from) trapezoids[trapezoid].lowerRight = to;
+}
+
+template <typename Coord>
+uint32_t BasicPointLocator<Coord>::findStart(uint32_t segment) const {
+    // trapezio a direita do extremo esquerdo; se o extremo ja esta sobre um
+    // segmento (vertice compartilhado), decide pelo outro extremo
+    const Point& p = points[segments[segment].left];
+    const Point& q = points[segments[segment].right];
+    uint32_t node = 0;
+    while (nodes[node].type != NodeType::LEAF) {
+        const Node& current = nodes[node];
+        if (current.type == NodeType::X) {
+            node = lexLess(p, points[current.key]) ? current.left : current.right;
+            continue;
+        }
+        bool collinear;
+        bool above = isAbove(p, current.key, collinear);
+        if (collinear) {
+            above = isAbove(q, current.key, collinear);
+            if (collinear) {
+                return NONE;  // arestas colineares sobrepostas
+            }
+        }
+        node = above ? current.left : current.right;
+    }
+    return nodes[node].key;
+}
+
+template <typename Coord>
+bool BasicPointLocator<Coord>::insertSegment(uint32_t s) {
+    uint32_t pId = segments[s].left;
+    uint32_t qId = segments[s].right;
+    const Point p = points[pId];
+    const Point q = points[qId];
+
+    // trapezios atravessados pelo segmento, da esquerda para a direita
+    crossed.clear();
+    uint32_t t = findStart(s);
+    if (t == NONE) return false;
+    crossed.push_back(t);
+    while (trapezoids[t].rightp != NONE && lexLess(points[trapezoids[t].rightp], q)) {
+        bool collinear;
+        bool above = isAbove(points[trapezoids[t].rightp], s, collinear);
+        if (collinear) return false;
+        t = above ? trapezoids[t].lowerRight : trapezoids[t].upperRight;
+        if (t == NONE) return false;
+        crossed.push_back(t);
+    }
+
+    const Trapezoid first = trapezoids[crossed.front()];
+    const Trapezoid last = trapezoids[crossed.back()];
+    bool hasLeft = first.leftp == NONE || points[first.leftp] != p;
+    bool hasRight = last.rightp == NONE || points[last.rightp] != q;
+
+    // trapezios novos acima e abaixo do segmento; cada um cresce para a direita
+    // enquanto as paredes atravessadas estao do outro lado do segmento
+    upperOf.resize(crossed.size());
+    lowerOf.resize(crossed.size());
+    uint32_t upper = newTrapezoid(first.top, s, pId, NONE);
+    uint32_t lower = newTrapezoid(s, first.bottom, pId, NONE);
+
+    uint32_t leftPart = NONE;
+    if (hasLeft) {
+        leftPart = newTrapezoid(first.top, first.bottom, first.leftp, pId);
+        trapezoids[leftPart].upperLeft = first.upperLeft;
+        trapezoids[leftPart].lowerLeft = first.lowerLeft;
+        replaceRight(first.upperLeft, crossed.front(), leftPart);
+        replaceRight(first.lowerLeft, crossed.front(), leftPart);
+        trapezoids[leftPart].upperRight = upper;
+        trapezoids[leftPart].lowerRight = lower;
+        trapezoids[upper].upperLeft = leftPart;
+        trapezoids[lower].lowerLeft = leftPart;
+    } else {
+        // p ja define a parede esquerda: a parte acima de p fica com upper
+        trapezoids[upper].upperLeft = first.upperLeft;
+        if (first.upperLeft != NONE && trapezoids[first.upperLeft].upperRight == crossed.front()) {
+            trapezoids[first.upperLeft].upperRight = upper;
+        }
+        trapezoids[lower].lowerLeft = first.lowerLeft;
+        if (first.lowerLeft != NONE && trapezoids[first.lowerLeft].lowerRight == crossed.front()) {
+            trapezoids[first.lowerLeft].lowerRight = lower;
+        }
+    }
+
+    for (size_t j = 0; j + 1 < crossed.size(); j++) {
+        upperOf[j] = upper;
+        lowerOf[j] = lower;
+
+        uint32_t current = crossed[j];
+        uint32_t following = crossed[j + 1];
+        const Trapezoid cur = trapezoids[current];
+        const Trapezoid next = trapezoids[following];
+        uint32_t r = cur.rightp;
+        uint32_t curUpperRight = cur.upperRight;
+        uint32_t curLowerRight = cur.lowerRight;
+
+        bool collinear;
+        if (isAbove(points[r], s, collinear)) {
+            // a parede por r continua acima do segmento: fecha o trapezio de cima
+            uint32_t nextUpper = newTrapezoid(next.top, s, r, NONE);
+            trapezoids[upper].rightp = r;
+            trapezoids[upper].lowerRight = nextUpper;
+            if (curUpperRight == following) {
+                trapezoids[upper].upperRight = nextUpper;
+            } else {
+                trapezoids[upper].upperRight = curUpperRight;
+                replaceLeft(curUpperRight, current, upper);
+            }
+            trapezoids[nextUpper].lowerLeft = upper;
+            if (next.upperLeft == current) {
+                trapezoids[nextUpper].upperLeft = upper;
+            } else {
+                trapezoids[nextUpper].upperLeft = next.upperLeft;
+                replaceRight(next.upperLeft, following, nextUpper);
+            }
+            upper = nextUpper;
+        } else {
+            // parede abaixo do segmento: fecha o trapezio de baixo
+            uint32_t nextLower = newTrapezoid(s, next.bottom, r, NONE);
+            trapezoids[lower].rightp = r;
+            trapezoids[lower].upperRight = nextLower;
+            if (curLowerRight == following) {
+                trapezoids[lower].lowerRight = nextLower;
+            } else {
+                trapezoids[lower].lowerRight = curLowerRight;
+                replaceLeft(curLowerRight, current, lower);
+            }
+            trapezoids[nextLower].upperLeft = lower;
+            if (next.lowerLeft == current) {
+                trapezoids[nextLower].lowerLeft = lower;
+            } else {
+                trapezoids[nextLower].lowerLeft = next.lowerLeft;
+                replaceRight(next.lowerLeft, following, nextLower);
+            }
+            lower = nextLower;
+        }
+    }
+    upperOf.back() = upper;
+    lowerOf.back() = lower;
+
+    trapezoids[upper].rightp = qId;
+    trapezoids[lower].rightp = qId;
+    uint32_t rightPart = NONE;
+    if (hasRight) {
+        rightPart = newTrapezoid(last.top, last.bottom, qId, last.rightp);
+        trapezoids[rightPart].upperRight = last.upperRight;
+        trapezoids[rightPart].lowerRight = last.lowerRight;
+        replaceLeft(last.upperRight, crossed.back(), rightPart);
+        replaceLeft(last.lowerRight, crossed.back(), rightPart);
+        trapezoids[rightPart].upperLeft = upper;
+        trapezoids[rightPart].lowerLeft = lower;
+        trapezoids[upper].upperRight = rightPart;
+        trapezoids[lower].lowerRight = rightPart;
+    } else {
+        trapezoids[upper].upperRight = last.upperRight;
+        if (last.upperRight != NONE && trapezoids[last.upperRight].upperLeft == crossed.back()) {
+            trapezoids[last.upperRight].upperLeft = upper;
+        }
+        trapezoids[lower].lowerRight = last.lowerRight;
+        if (last.lowerRight != NONE && trapezoids[last.lowerRight].lowerLeft == crossed.back()) {
+            trapezoids[last.lowerRight].lowerLeft = lower;
+        }
+    }
+
+    // a folha de cada trapezio atravessado vira o teste contra o segmento,
+    // precedido pelos testes contra p e q nas pontas que ganharam trapezio
+    for (size_t j = 0; j < crossed.size(); j++) {
+        uint32_t node = trapezoids[crossed[j]].node;
+        bool splitLeft = j == 0 && hasLeft;
+        bool splitRight = j + 1 == crossed.size() && hasRight;
+
+        uint32_t above = leafOf(upperOf[j]);
+        uint32_t below = leafOf(lowerOf[j]);
+        uint32_t test = node;
+        if (splitLeft || splitRight) {
+            nodes.push_back({NodeType::Y, s, above, below});
+            test = (uint32_t)nodes.size() - 1;
+        } else {
+            nodes[node] = {NodeType::Y, s, above, below};
+        }
+
+        if (splitRight) {
+            uint32_t rightLeaf = leafOf(rightPart);
+            if (splitLeft) {
+                nodes.push_back({NodeType::X, qId, test, rightLeaf});
+                test = (uint32_t)nodes.size() - 1;
+            } else {
+                nodes[node] = {NodeType::X, qId, test, rightLeaf};
+            }
+        }
+        if (splitLeft) {
+            uint32_t leftLeaf = leafOf(leftPart);
+            nodes[node] = {NodeType::X, pId, leftLeaf, test};
+        }
+    }
+    return true;
+}
+
+template <typename Coord>
+bool BasicPointLocator<Coord>::build(const BasicDCEL<Coord>& dcel) {
+    if (dcel.validate() != DCELBase::Verdict::VALID) {
+        fprintf(stderr, "erro: localizacao de pontos requer uma malha valida\n");
+        return false;
+    }
+
+    points.resize(dcel.getVertexCount());
+    for (uint32_t v = 0; v < points.size(); v++) {
+        points[v] = dcel.vertexPosition(v);
+    }
+
+    // lado das faces: com faces a esquerda das half-edges, so as faces externas
+    // (uma por componente) percorrem o contorno no sentido horario; com faces a
+    // direita, so elas no anti-horario. areas exatas em 128 bits: as somas
+    // parciais podem dar a volta, mas o dobro da area de uma face com coordenadas
+    // em (-2^62, 2^62) cabe em __int128, entao o total modulo 2^128 eh o certo
+    // a validacao aceita twins na mesma direcao, que deixam cadeias sem next ou
+    // com o next fora da aresta do twin; sem elas nao ha destino confiavel, e a
+    // malha eh recusada
+    std::vector<unsigned __int128> area(dcel.getFaceCount(), 0);
+    for (uint32_t he = 0; he < dcel.getHalfEdgeCount(); he++) {
+        uint32_t next = dcel.next(he), twin = dcel.twin(he);
+        if (next == NONE || twin == NONE || dcel.origin(next) != dcel.origin(twin) ||
+            dcel.origin(twin) == dcel.origin(he)) {
+            fprintf(stderr, "erro: localizacao de pontos: a cadeia da face %u nao fecha\n",
+                    dcel.incidentFace(he) + 1);
+            return false;
+        }
+        const Point& a = points[dcel.origin(he)];
+        const Point& b = points[dcel.origin(dcel.next(he))];
+        area[dcel.incidentFace(he)] += (unsigned __int128)((__int128)a.x * b.y) -
+                                       (unsigned __int128)((__int128)b.x * a.y);
+    }
+    size_t clockwise = 0, counterClockwise = 0;
+    for (unsigned __int128 sum : area) {
+        __int128 value = (__int128)sum;
+        if (value < 0) clockwise++;
+        if (value > 0) counterClockwise++;
+    }
+    bool facesOnLeft = clockwise <= counterClockwise;
+
+    // um segmento por par de twins, com os extremos em ordem lexicografica
+    segments.clear();
+    for (uint32_t he = 0; he < dcel.getHalfEdgeCount(); he++) {
+        uint32_t twin = dcel.twin(he);
+        if (twin < he) continue;
+        uint32_t a = dcel.origin(he);
+        uint32_t b = dcel.origin(twin);
+        if (points[a] == points[b]) continue;
+
+        // he vai da esquerda para a direita: sua face fica acima se as faces
+        // estao a esquerda das half-edges
+        bool forward = lexLess(points[a], points[b]);
+        uint32_t rightward = forward ? he : twin;
+        uint32_t leftward = forward ? twin : he;
+        uint32_t above = facesOnLeft ? rightward : leftward;
+        uint32_t below = facesOnLeft ? leftward : rightward;
+        segments.push_back({forward ? a : b, forward ? b : a,
+                            dcel.incidentFace(above), dcel.incidentFace(below)});
+    }
+
+    // face externa para pontos fora do alcance de qualquer segmento: a de cima
+    // do segmento mais alto que parte do vertice lexicograficamente menor
+    outerFace = 0;
+    uint32_t best = NONE;
+    for (uint32_t s = 0; s < segments.size(); s++) {
+        if (best == NONE) {
+            best = s;
+            continue;
+        }
+        const Point& left = points[segments[s].left];
+        const Point& bestLeft = points[segments[best].left];
+        if (lexLess(left, bestLeft)) {
+            best = s;
+        } else if (left == bestLeft && Geometry::orientation(left, points[segments[best].right],
+                                                             points[segments[s].right]) ==
+                                           Geometry::Orientation::HORARIO) {
+            best = s;
+        }
+    }
+    if (best != NONE) {
+        outerFace = segments[best].faceAbove;
+    }
+
+    // mapa inicial: um trapezio ilimitado
+    trapezoids.clear();
+    nodes.clear();
+    trapezoids.reserve(3 * segments.size() + 1);
+    nodes.reserve(6 * segments.size() + 1);
+    newTrapezoid(NONE, NONE, NONE, NONE);
+    leafOf(0);
+
+    // ordem de insercao aleatoria com vies (BRIO): rodadas de tamanho dobrando,
+    // sorteadas ao acaso, cada uma percorrida na ordem de Morton. o sorteio das
+    // rodadas mantem os limites esperados e a ordem espacial dentro delas evita
+    // que cada descida no grafo seja uma sequencia de faltas de cache
+    std::vector<std::pair<uint64_t, uint32_t>> order(segments.size());
+    for (uint32_t s = 0; s < order.size(); s++) {
+        order[s] = {mortonKey(points[segments[s].left]), s};
+    }
+    std::shuffle(order.begin(), order.end(), std::mt19937(INSERTION_SEED));
+    size_t roundEnd = order.size();
+    while (roundEnd - roundEnd / 2 >= MIN_SORTED_ROUND) {
+        std::sort(order.begin() + roundEnd / 2, order.begin() + roundEnd);
+        roundEnd /= 2;
+    }
+
+    for (const auto& entry : order) {
+        if (!insertSegment(entry.second)) {
+            fprintf(stderr, "erro: localizacao de pontos: arestas sobrepostas\n");
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename Coord>
+uint32_t BasicPointLocator<Coord>::locate(const Point& point) const {
+    if (nodes.empty()) {
+        return 0;
+    }
+
+    uint32_t node = 0;
+    while (nodes[node].type != NodeType::LEAF) {
+        const Node& current = nodes[node];
+        if (current.type == NodeType::X) {
+            node = lexLess(point, points[current.key]) ? current.left : current.right;
+        } else {
+            bool collinear;
+            bool above = isAbove(point, current.key, collinear);
+            node = above || collinear ? current.left : current.right;
+        }
+    }
+
+    const Trapezoid& trapezoid = trapezoids[nodes[node].key];
+    uint32_t face = trapezoid.top != NONE      ? segments[trapezoid.top].faceBelow
+                    : trapezoid.bottom != NONE ? segments[trapezoid.bottom].faceAbove
+                                               : outerFace;
+    return face + 1;
+}
+
+template <typename Coord>
+void BasicPointLocator<Coord>::locateBatch(const Point* queries, size_t count, uint32_t* faces,
+                               unsigned threads) const {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = (unsigned)std::min<size_t>(threads, count / MIN_BATCH_PER_THREAD + 1);
+
+    // consultas respondidas na ordem de Morton: pontos vizinhos descem por
+    // caminhos quase iguais do grafo, que ficam no cache
+    std::vector<std::pair<uint64_t, uint32_t>> sorted(count);
+    for (size_t i = 0; i < count; i++) {
+        sorted[i] = {mortonKey(queries[i]), (uint32_t)i};
+    }
+    std::sort(sorted.begin(), sorted.end());
+
+    auto work = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            faces[sorted[i].second] = locate(queries[sorted[i].second]);
+        }
+    };
+
+    // a estrutura so eh lida nas consultas, entao as threads nao se coordenam
+    std::vector<std::thread> workers;
+    size_t chunk = (count + threads - 1) / threads;
+    for (unsigned t = 1; t < threads; t++) {
+        size_t begin = std::min(count, t * chunk);
+        size_t end = std::min(count, begin + chunk);
+        workers.emplace_back(work, begin, end);
+    }
+    work(0, std::min(count, chunk));
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+// instancias para cada largura de coordenada (coordinate.h)
+template class BasicPointLocator<int16_t>;
+template class BasicPointLocator<int32_t>;
+template class BasicPointLocator<int64_t>;
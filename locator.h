@@ -0,0 +1,80 @@
+#ifndef LOCATOR_H
+#define LOCATOR_H
+
+#include "DCEL.h"
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// localizacao de pontos por mapa trapezoidal sobre as arestas de uma DCEL valida:
+// construcao incremental em ordem aleatoria (O(n log n) esperado, O(n) de memoria)
+// e consulta O(log n) esperada descendo o grafo de busca. os testes usam
+// Geometry::orientation e a ordem lexicografica (x, depois y), que faz o papel do
+// cisalhamento simbolico para pontos com o mesmo x. instanciado para as mesmas
+// larguras de coordenada que BasicDCEL
+template <typename Coord>
+class BasicPointLocator {
+public:
+    using Point = BasicPoint<Coord>;
+
+    // a DCEL precisa ser valida e ter as cadeias next fechadas (false, com a
+    // mensagem no stderr, se nao tiver); as faces sao copiadas, a DCEL pode ser
+    // descartada
+    bool build(const BasicDCEL<Coord>& dcel);
+
+    // face que contem o ponto, 1-based como em printDCEL; pontos sobre uma aresta
+    // ficam com a face de cima (a da esquerda, em arestas verticais) e pontos fora
+    // da malha com a face externa
+    uint32_t locate(const Point& point) const;
+
+    // consultas em lote divididas entre threads (0 usa todos os nucleos)
+    void locateBatch(const Point* points, size_t count, uint32_t* faces,
+                     unsigned threads = 0) const;
+
+private:
+    // aresta com extremos em ordem lexicografica e as faces de cada lado
+    struct Segment {
+        uint32_t left, right;
+        uint32_t faceAbove, faceBelow;
+    };
+
+    // trapezio limitado por dois segmentos (NONE = ilimitado) e pelas retas
+    // verticais por leftp e rightp (NONE = infinito); cada parede lateral tem
+    // ate dois vizinhos, acima e abaixo do ponto que a define
+    struct Trapezoid {
+        uint32_t top, bottom;
+        uint32_t leftp, rightp;
+        uint32_t upperLeft, lowerLeft, upperRight, lowerRight;
+        uint32_t node;
+    };
+
+    // no do grafo de busca: X compara com um ponto (left/right), Y com um
+    // segmento (left = acima, right = abaixo) e folha aponta o trapezio
+    enum class NodeType : uint8_t { X, Y, LEAF };
+    struct Node {
+        NodeType type;
+        uint32_t key;
+        uint32_t left, right;
+    };
+
+    std::vector<Point> points;
+    std::vector<Segment> segments;
+    std::vector<Trapezoid> trapezoids;
+    std::vector<Node> nodes;
+    uint32_t outerFace = 0;
+
+    // memoria de trabalho de insertSegment, reaproveitada entre insercoes
+    std::vector<uint32_t> crossed, upperOf, lowerOf;
+
+    bool isAbove(const Point& point, uint32_t segment, bool& collinear) const;
+    uint32_t newTrapezoid(uint32_t top, uint32_t bottom, uint32_t leftp, uint32_t rightp);
+    uint32_t leafOf(uint32_t trapezoid);
+    void replaceLeft(uint32_t trapezoid, uint32_t from, uint32_t to);
+    void replaceRight(uint32_t trapezoid, uint32_t from, uint32_t to);
+    uint32_t findStart(uint32_t segment) const;
+    bool insertSegment(uint32_t segment);
+};
+
+using PointLocator = BasicPointLocator<int32_t>;
+
+#endif
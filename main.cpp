@@ -1,17 +1,404 @@
 #include "DCEL.h"
+#include "batch.h"
+#include "diagnosis.h"
+#include "dual.h"
+#include "locator.h"
+#include "overlay.h"
+#include "parser.h"
+#include "stats.h"
+#include "writer.h"
+#include <algorithm>
+#include <vector>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
 
-int main() {
-    DCEL dcel;
-    
-    if (!dcel.loadFromInput()) {
+// localiza cada ponto e escreve a face (1-based) de cada um, uma por linha
+template <typename Coord>
+static bool locatePoints(const BasicPointLocator<Coord>& locator, const std::vector<int64_t>& x,
+                         const std::vector<int64_t>& y, int fd) {
+    std::vector<BasicPoint<Coord>> queries(x.size());
+    for (size_t i = 0; i < queries.size(); i++) {
+        queries[i] = BasicPoint<Coord>((Coord)x[i], (Coord)y[i]);
+    }
+    std::vector<uint32_t> faces(queries.size());
+    locator.locateBatch(queries.data(), queries.size(), faces.data());
+
+    OutputBuffer out(fd);
+    for (uint32_t face : faces) {
+        out.putNumber(face);
+        out.put('\n');
+    }
+    return out.flush();
+}
+
+// sobrepoe a (ja validada) e a malha de --overlay; build recusa b invalida
+template <typename Coord>
+static bool overlayMaps(const BasicDCEL<Coord>& a, const MeshData& mesh, BasicDCEL<Coord>& result,
+                        BasicMapOverlay<Coord>& overlay) {
+    BasicDCEL<Coord> b;
+    if (!b.loadFromMesh(mesh)) {
+        return false;
+    }
+    return overlay.build(a, b, result);
+}
+
+// DCEL da sobreposicao seguida de uma linha "faceA faceB" por face, as faces de
+// origem em a e em b (1-based, como em printDCEL)
+template <typename Coord>
+static bool writeOverlay(const BasicDCEL<Coord>& result, const BasicMapOverlay<Coord>& overlay, int fd) {
+    if (!result.printDCEL(fd)) {
+        return false;
+    }
+    OutputBuffer out(fd);
+    for (uint32_t f = 0; f < result.getFaceCount(); f++) {
+        out.putNumber(overlay.faceOfA(f) + 1);
+        out.put(' ');
+        out.putNumber(overlay.faceOfB(f) + 1);
+        out.put('\n');
+    }
+    return out.flush();
+}
+
+// descritor de saida: o arquivo de --output ou a saida padrao; -1 em erro
+static int openOutput(const char* outputPath) {
+    // o descritor recebe a saida direto, sem passar pelo buffer de stdio
+    fflush(stdout);
+    if (!outputPath) {
+        return STDOUT_FILENO;
+    }
+    int fd = open(outputPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "erro: %s: %s\n", outputPath, strerror(errno));
+    }
+    return fd;
+}
+
+// fecha o arquivo de --output e reporta falhas de escrita
+static bool closeOutput(int fd, const char* outputPath, bool written) {
+    if (outputPath && close(fd) != 0) {
+        written = false;
+    }
+    if (!written) {
+        fprintf(stderr, "erro: %s: falha ao gravar saida\n", outputPath ? outputPath : "saida padrao");
+    }
+    return written;
+}
+
+struct Options {
+    const char* inputPath = nullptr;
+    const char* loadSnapshotPath = nullptr;
+    const char* saveSnapshotPath = nullptr;
+    const char* outputPath = nullptr;
+    const char* locatePath = nullptr;
+    const char* statsPath = nullptr;
+    const char* batchPath = nullptr;
+    const char* dualBinaryPath = nullptr;
+    const char* overlayPath = nullptr;
+    unsigned threads = 1;
+    bool streaming = false;
+    bool reorder = false;
+    bool weld = false;
+    bool batchStream = false;
+    bool quadratic = false;
+    bool diagnose = false;
+    bool dual = false;
+    bool stats = false;
+};
+
+// o que eh lido antes de escolher a largura das coordenadas: a malha inteira, so
+// o cabecalho (--stream, as faces ficam no parser) ou nada (snapshot, cuja
+// largura vem do cabecalho do arquivo), os pontos de --locate e a segunda malha
+// de --overlay
+struct Input {
+    MeshParser parser;
+    MeshData mesh;
+    MeshData overlayMesh;
+    int nFaces = 0;
+    std::vector<int64_t> pointX, pointY;
+    CoordinateWidth width = CoordinateWidth::BITS32;
+};
+
+static bool readInput(const Options& options, Input& input) {
+    if (options.locatePath) {
+        MeshParser points;
+        bool parsed = points.openFile(options.locatePath) &&
+                      points.parsePoints(input.pointX, input.pointY);
+        if (!parsed) {
+            fprintf(stderr, "erro: %s: %s\n", options.locatePath, points.getError().c_str());
+            return false;
+        }
+    }
+
+    if (options.loadSnapshotPath) {
+        return readSnapshotWidth(options.loadSnapshotPath, input.width);
+    }
+
+    MeshParser& parser = input.parser;
+    bool opened = options.inputPath ? parser.openFile(options.inputPath) : parser.openStdin();
+    bool parsed;
+    if (options.streaming) {
+        parsed = opened && parser.parseHeader(input.mesh, input.nFaces);
+    } else {
+        Stats::Timer timer(Stats::PARSE);
+        parsed = opened && parser.parse(input.mesh);
+    }
+    if (!parsed) {
+        fprintf(stderr, "erro: %s\n", parser.getError().c_str());
+        return false;
+    }
+    if (options.overlayPath) {
+        MeshParser other;
+        if (!other.openFile(options.overlayPath) || !other.parse(input.overlayMesh)) {
+            fprintf(stderr, "erro: %s: %s\n", options.overlayPath, other.getError().c_str());
+            return false;
+        }
+    }
+    if (options.weld) {
+        Stats::Timer timer(Stats::WELD);
+        size_t merged = input.mesh.weldVertices() + input.overlayMesh.weldVertices();
+        Stats::add(Stats::WELDED_VERTICES, merged);
+        if (merged > 0) {
+            fprintf(stderr, "aviso: %zu vertices com coordenadas repetidas soldados\n", merged);
+        }
+    }
+
+    // a menor instancia em que as malhas e os pontos consultados sao exatos
+    int64_t low = 0, high = 0;
+    input.mesh.coordinateRange(low, high);
+    int64_t otherLow, otherHigh;
+    if (input.overlayMesh.coordinateRange(otherLow, otherHigh)) {
+        low = std::min(low, otherLow);
+        high = std::max(high, otherHigh);
+    }
+    for (size_t i = 0; i < input.pointX.size(); i++) {
+        low = std::min({low, input.pointX[i], input.pointY[i]});
+        high = std::max({high, input.pointX[i], input.pointY[i]});
+    }
+    if (!narrowestWidth(low, high, input.width)) {
+        fprintf(stderr, "erro: coordenadas fora do intervalo suportado (-2^62, 2^62)\n");
+        return false;
+    }
+    return true;
+}
+
+// carrega, valida e grava a saida; devolve o codigo de saida do programa
+template <typename Coord>
+static int run(const Options& options, Input& input) {
+    BasicDCEL<Coord> dcel;
+    if (options.quadratic) {
+        dcel.setIntersectionMethod(DCELBase::IntersectionMethod::QUADRATIC);
+    }
+    dcel.setConstructionThreads(options.threads);
+
+    bool loaded = options.loadSnapshotPath ? dcel.loadSnapshot(options.loadSnapshotPath)
+                : options.streaming        ? dcel.loadFromInputStreaming(input.parser, input.mesh,
+                                                                         input.nFaces)
+                                           : dcel.loadFromMesh(input.mesh);
+    input.mesh.clear();
+    if (!loaded) {
         fprintf(stderr, "erro: falha ao carregar entrada\n");
         return 1;
     }
+    bool dual = options.dual || options.dualBinaryPath;
+    if (options.reorder) {
+        dcel.reorderForLocality();
+    }
+    
+    if (options.diagnose) {
+        // relatorio completo de defeitos no lugar do veredito e da DCEL
+        BasicDiagnosis<Coord> diagnosis;
+        dcel.diagnose(diagnosis);
+        int fd = openOutput(options.outputPath);
+        if (fd < 0) {
+            return 1;
+        }
+        bool written = writeDiagnosis(dcel, diagnosis, fd);
+        return closeOutput(fd, options.outputPath, written) ? 0 : 1;
+    }
     
     if (dcel.isValidDCEL()) {
-        dcel.printDCEL();
+        if (options.saveSnapshotPath && !dcel.saveSnapshot(options.saveSnapshotPath)) {
+            return 1;
+        }
+        // pontos de --locate fora do intervalo de um snapshot mais estreito
+        for (size_t i = 0; i < input.pointX.size(); i++) {
+            if (!fitsCoordinate<Coord>(input.pointX[i]) ||
+                !fitsCoordinate<Coord>(input.pointY[i])) {
+                fprintf(stderr, "erro: %s: ponto %zu fora do intervalo de coordenadas de %zu bits\n",
+                        options.locatePath, i + 1, sizeof(Coord) * 8);
+                return 1;
+            }
+        }
+        // a localizacao eh montada antes de abrir a saida, que nao recebe nada se
+        // a malha for recusada
+        BasicPointLocator<Coord> locator;
+        if (options.locatePath && !locator.build(dcel)) {
+            return 1;
+        }
+        BasicDCEL<Coord> overlaid;
+        BasicMapOverlay<Coord> overlay;
+        if (options.overlayPath && !overlayMaps(dcel, input.overlayMesh, overlaid, overlay)) {
+            return 1;
+        }
+        BasicDualGraph<Coord> graph;
+        if (dual) {
+            if (!graph.build(dcel, options.threads) ||
+                (options.dualBinaryPath && !graph.save(options.dualBinaryPath))) {
+                return 1;
+            }
+        }
+        int fd = openOutput(options.outputPath);
+        if (fd < 0) {
+            return 1;
+        }
+        Stats::Timer timer(Stats::OUTPUT);
+        bool written = options.locatePath  ? locatePoints(locator, input.pointX, input.pointY, fd)
+                     : options.dual        ? graph.write(fd)
+                     : options.overlayPath ? writeOverlay(overlaid, overlay, fd)
+                                           : dcel.printDCEL(fd);
+        timer.stop();
+        if (!closeOutput(fd, options.outputPath, written)) {
+            return 1;
+        }
     }
     
     return 0;
-}
\ No newline at end of file
+}
+
+// --batch e --batch-stream: uma linha com o veredito de cada malha, no lugar da DCEL
+static int runBatch(const Options& options) {
+    int fd = openOutput(options.outputPath);
+    if (fd < 0) {
+        return 1;
+    }
+    Batch::Summary summary;
+    OutputBuffer out(fd);
+    bool read = options.batchPath
+                    ? Batch::validateFiles(options.batchPath, options.threads, out, summary)
+                    : Batch::validateStream(options.inputPath, options.threads, out, summary);
+    if (!closeOutput(fd, options.outputPath, out.flush())) {
+        return 1;
+    }
+    return read && summary.failed == 0 ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--quadratic") == 0) {
+            // teste de superposicao par a par, para conferir a linha de varredura
+            options.quadratic = true;
+        } else if (strcmp(argv[i], "--stream") == 0) {
+            // leitura e construcao em paralelo, sem guardar a malha textual inteira
+            options.streaming = true;
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            // construcao da DCEL em paralelo (0 usa todos os nucleos), mesma saida
+            options.threads = (unsigned)strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--reorder") == 0) {
+            // renumera por localidade antes de validar; a saida usa a numeracao da entrada
+            options.reorder = true;
+        } else if (strcmp(argv[i], "--weld") == 0) {
+            // junta vertices de coordenadas iguais antes da construcao
+            options.weld = true;
+        } else if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            // valida cada malha de um diretorio ou de uma lista de caminhos
+            options.batchPath = argv[++i];
+        } else if (strcmp(argv[i], "--batch-stream") == 0) {
+            // valida cada malha de uma entrada com varias malhas concatenadas
+            options.batchStream = true;
+        } else if (strcmp(argv[i], "--load-snapshot") == 0 && i + 1 < argc) {
+            // le a DCEL ja construida de um snapshot binario em vez da entrada texto
+            options.loadSnapshotPath = argv[++i];
+        } else if (strcmp(argv[i], "--save-snapshot") == 0 && i + 1 < argc) {
+            // grava o snapshot binario se a malha for valida
+            options.saveSnapshotPath = argv[++i];
+        } else if (strcmp(argv[i], "--locate") == 0 && i + 1 < argc) {
+            // em vez da DCEL, imprime a face que contem cada ponto do arquivo
+            options.locatePath = argv[++i];
+        } else if (strcmp(argv[i], "--dual") == 0) {
+            // em vez da DCEL, imprime a adjacencia entre faces em CSR
+            options.dual = true;
+        } else if (strcmp(argv[i], "--dual-binary") == 0 && i + 1 < argc) {
+            // grava a adjacencia entre faces em binario se a malha for valida
+            options.dualBinaryPath = argv[++i];
+        } else if (strcmp(argv[i], "--overlay") == 0 && i + 1 < argc) {
+            // em vez da DCEL, imprime a sobreposicao com a malha do arquivo
+            options.overlayPath = argv[++i];
+        } else if (strcmp(argv[i], "--diagnose") == 0) {
+            // todos os defeitos em JSON Lines, no lugar do veredito de uma palavra
+            options.diagnose = true;
+        } else if (strcmp(argv[i], "--stats") == 0) {
+            // tempo por fase, contadores e pico de memoria no stderr
+            options.stats = true;
+        } else if (strcmp(argv[i], "--stats-json") == 0 && i + 1 < argc) {
+            // mesmas estatisticas gravadas em JSON
+            options.statsPath = argv[++i];
+        } else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            // grava a DCEL no arquivo indicado em vez da saida padrao
+            options.outputPath = argv[++i];
+        } else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+            fprintf(stderr, "erro: opcao desconhecida: %s\n", argv[i]);
+            return 1;
+        } else if (!options.inputPath) {
+            // arquivo de entrada opcional, mapeado em memoria
+            options.inputPath = strcmp(argv[i], "-") == 0 ? nullptr : argv[i];
+        } else {
+            fprintf(stderr, "erro: mais de um arquivo de entrada\n");
+            return 1;
+        }
+    }
+    
+    if (options.weld && (options.streaming || options.loadSnapshotPath)) {
+        // a solda renumera as faces, que --stream le depois e o snapshot nem tem
+        fprintf(stderr, "erro: --weld nao se aplica a --stream nem a --load-snapshot\n");
+        return 1;
+    }
+    if (options.overlayPath && (options.streaming || options.loadSnapshotPath || options.diagnose ||
+                                options.locatePath || options.dual || options.dualBinaryPath)) {
+        // a sobreposicao precisa das duas malhas inteiras e tem saida propria
+        fprintf(stderr, "erro: --overlay nao se aplica a --stream, --load-snapshot, --diagnose, "
+                        "--locate nem --dual\n");
+        return 1;
+    }
+    if (options.reorder && (options.diagnose || options.dual || options.dualBinaryPath)) {
+        // o relatorio de --diagnose e o grafo dual usam a numeracao interna, entao
+        // ficam na da entrada
+        fprintf(stderr, "aviso: --reorder ignorado com --diagnose e --dual\n");
+        options.reorder = false;
+    }
+    if (options.batchPath || options.batchStream) {
+        // as fases de cada malha se sobrepoem entre as threads, sem tempo por fase
+        if (options.stats || options.statsPath) {
+            fprintf(stderr, "erro: --stats nao se aplica a validacao em lote\n");
+            return 1;
+        }
+        return runBatch(options);
+    }
+    if (options.stats || options.statsPath) {
+        Stats::enable();
+    }
+    // a largura das coordenadas eh escolhida pela entrada; cada uma tem sua instancia
+    Input input;
+    int status = 1;
+    if (readInput(options, input)) {
+        switch (input.width) {
+            case CoordinateWidth::BITS16: status = run<int16_t>(options, input); break;
+            case CoordinateWidth::BITS32: status = run<int32_t>(options, input); break;
+            case CoordinateWidth::BITS64: status = run<int64_t>(options, input); break;
+        }
+    } else {
+        fprintf(stderr, "erro: falha ao carregar entrada\n");
+    }
+    if (options.stats) {
+        Stats::report(stderr);
+    }
+    if (options.statsPath && !Stats::writeJson(options.statsPath)) {
+        status = 1;
+    }
+    return status;
+}
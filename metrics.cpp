@@ -0,0 +1,119 @@
+#include "metrics.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+namespace {
+    // faces reservadas por vez por cada thread; a face externa sozinha pode ter
+    // tantas half-edges quanto o resto, entao a divisao eh dinamica
+    const size_t FACES_PER_BLOCK = 1024;
+}
+
+template <typename Coord>
+void BasicFaceMetrics<Coord>::measureFace(const BasicDCEL<Coord>& dcel, uint32_t f) {
+    using UnsignedWide = typename CoordinateTraits<Coord>::UnsignedWide;
+
+    Coord lowX = std::numeric_limits<Coord>::max(), lowY = lowX;
+    Coord highX = std::numeric_limits<Coord>::min(), highY = highX;
+
+    // coordenadas relativas ao primeiro vertice: diferencas e produtos cabem em
+    // Wide como no predicado de orientacao. os parciais da soma podem passar do
+    // intervalo, entao ela acumula sem sinal (modulo 2^bits) e so o total, que eh
+    // o dobro da area, volta para Wide
+    Point first;
+    Wide prevX = 0, prevY = 0;
+    UnsignedWide cross = 0;
+    double momentX = 0, momentY = 0, sumX = 0, sumY = 0, perimeterSum = 0;
+    size_t count = 0;
+    for (uint32_t v : dcel.faceVertices(f)) {
+        Point p = dcel.vertexPosition(v);
+        lowX = std::min(lowX, p.x);
+        lowY = std::min(lowY, p.y);
+        highX = std::max(highX, p.x);
+        highY = std::max(highY, p.y);
+
+        if (count == 0) {
+            first = p;
+        }
+        Wide x = (Wide)p.x - first.x, y = (Wide)p.y - first.y;
+        Wide term = prevX * y - x * prevY;
+        cross += (UnsignedWide)term;
+        momentX += (double)(prevX + x) * (double)term;
+        momentY += (double)(prevY + y) * (double)term;
+        perimeterSum += std::hypot((double)(x - prevX), (double)(y - prevY));
+        sumX += (double)x;
+        sumY += (double)y;
+        prevX = x;
+        prevY = y;
+        count++;
+    }
+    // aresta de volta ao primeiro vertice: o termo do laco eh 0 na origem relativa
+    perimeterSum += std::hypot((double)prevX, (double)prevY);
+
+    Wide area = (Wide)cross;
+    doubleArea[f] = area;
+    if (area != 0) {
+        centerX[f] = first.x + momentX / (3.0 * (double)area);
+        centerY[f] = first.y + momentY / (3.0 * (double)area);
+    } else if (count > 0) {
+        centerX[f] = first.x + sumX / count;
+        centerY[f] = first.y + sumY / count;
+    } else {
+        centerX[f] = centerY[f] = 0;
+    }
+    length[f] = perimeterSum;
+    minX[f] = lowX;
+    minY[f] = lowY;
+    maxX[f] = highX;
+    maxY[f] = highY;
+}
+
+template <typename Coord>
+void BasicFaceMetrics<Coord>::compute(const BasicDCEL<Coord>& dcel, unsigned threads) {
+    size_t faces = dcel.getFaceCount();
+    doubleArea.assign(faces, 0);
+    centerX.assign(faces, 0);
+    centerY.assign(faces, 0);
+    length.assign(faces, 0);
+    minX.assign(faces, 0);
+    minY.assign(faces, 0);
+    maxX.assign(faces, 0);
+    maxY.assign(faces, 0);
+
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = (unsigned)std::min<size_t>(threads, faces / FACES_PER_BLOCK + 1);
+
+    // cada face so escreve a propria posicao dos vetores e a DCEL so eh lida,
+    // entao as threads so disputam o contador de blocos
+    std::atomic<size_t> nextBlock(0);
+    auto work = [&]() {
+        for (;;) {
+            size_t begin = nextBlock.fetch_add(FACES_PER_BLOCK, std::memory_order_relaxed);
+            if (begin >= faces) {
+                break;
+            }
+            size_t end = std::min(faces, begin + FACES_PER_BLOCK);
+            for (size_t f = begin; f < end; f++) {
+                measureFace(dcel, (uint32_t)f);
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < threads; t++) {
+        workers.emplace_back(work);
+    }
+    work();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+// instancias para cada largura de coordenada (coordinate.h)
+template class BasicFaceMetrics<int16_t>;
+template class BasicFaceMetrics<int32_t>;
+template class BasicFaceMetrics<int64_t>;
@@ -0,0 +1,55 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include "DCEL.h"
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// medidas de todas as faces de uma DCEL em uma passada por face (metrics.cpp):
+// area com sinal exata (formula do laco em CoordinateTraits<Coord>::Wide),
+// centroide do poligono, perimetro e caixa envolvente, guardados em vetores
+// paralelos indexados pela face (0-based). as faces sao divididas entre threads
+// e cada uma percorre o proprio ciclo uma vez. a area e o centroide supoem faces
+// simples, como as de uma DCEL valida; instanciado para as mesmas larguras de
+// coordenada que BasicDCEL
+template <typename Coord>
+class BasicFaceMetrics {
+public:
+    using Point = BasicPoint<Coord>;
+    using Wide = typename CoordinateTraits<Coord>::Wide;
+
+    // recalcula tudo; qualquer edicao posterior da DCEL deixa as medidas velhas
+    // (0 usa todos os nucleos)
+    void compute(const BasicDCEL<Coord>& dcel, unsigned threads = 0);
+
+    size_t getFaceCount() const { return doubleArea.size(); }
+
+    // o dobro da area com sinal, exato: positivo em faces anti-horarias (as
+    // internas, na entrada usual), negativo na face externa e 0 em faces vagas
+    // ou degeneradas
+    Wide twiceSignedArea(uint32_t f) const { return doubleArea[f]; }
+    double signedArea(uint32_t f) const { return (double)doubleArea[f] / 2; }
+    bool isCounterClockwise(uint32_t f) const { return doubleArea[f] > 0; }
+
+    // centroide da regiao do poligono; em faces de area 0 eh a media dos vertices
+    double centroidX(uint32_t f) const { return centerX[f]; }
+    double centroidY(uint32_t f) const { return centerY[f]; }
+    double perimeter(uint32_t f) const { return length[f]; }
+
+    // caixa envolvente; em faces vagas, min > max
+    Point boundsMin(uint32_t f) const { return Point(minX[f], minY[f]); }
+    Point boundsMax(uint32_t f) const { return Point(maxX[f], maxY[f]); }
+
+private:
+    std::vector<Wide> doubleArea;
+    std::vector<double> centerX, centerY;
+    std::vector<double> length;
+    std::vector<Coord> minX, minY, maxX, maxY;
+
+    void measureFace(const BasicDCEL<Coord>& dcel, uint32_t f);
+};
+
+using FaceMetrics = BasicFaceMetrics<int32_t>;
+
+#endif
@@ -0,0 +1,799 @@
+#include "overlay.h"
+#include "geometry.h"
+#include "grid.h"
+#include "parser.h"
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <set>
+
+namespace {
+    const uint32_t NONE = DCELBase::NONE;
+
+    int signOf(int128_t a) {
+        return (a > 0) - (a < 0);
+    }
+
+    // |a| sem sinal, sem estouro no menor int128
+    uint128_t magnitude(int128_t a) {
+        return a < 0 ? -(uint128_t)a : (uint128_t)a;
+    }
+
+    // produto de 128 x 128 bits sem sinal em 256 bits (hi, lo), por metades de 64
+    void multiply(uint128_t x, uint128_t y, uint128_t& hi, uint128_t& lo) {
+        const uint128_t MASK = UINT64_MAX;
+        uint128_t p00 = (x & MASK) * (y & MASK), p01 = (x & MASK) * (y >> 64);
+        uint128_t p10 = (x >> 64) * (y & MASK), p11 = (x >> 64) * (y >> 64);
+        uint128_t mid = (p00 >> 64) + (p01 & MASK) + (p10 & MASK);
+        lo = (p00 & MASK) | (mid << 64);
+        hi = p11 + (p01 >> 64) + (p10 >> 64) + (mid >> 64);
+    }
+
+    // sinal de a * b - c * d, exato para quaisquer valores de 128 bits
+    int compareProducts(int128_t a, int128_t b, int128_t c, int128_t d) {
+        int left = signOf(a) * signOf(b), right = signOf(c) * signOf(d);
+        if (left != right) {
+            return left > right ? 1 : -1;
+        }
+        if (left == 0) {
+            return 0;
+        }
+        uint128_t leftHi, leftLo, rightHi, rightLo;
+        multiply(magnitude(a), magnitude(b), leftHi, leftLo);
+        multiply(magnitude(c), magnitude(d), rightHi, rightLo);
+        int order = leftHi != rightHi ? (leftHi > rightHi ? 1 : -1)
+                  : leftLo != rightLo ? (leftLo > rightLo ? 1 : -1)
+                                      : 0;
+        return left > 0 ? order : -order;
+    }
+
+    // ponto (x / d, y / d) com d > 0: vertices de entrada (d = 1) e cruzamentos.
+    // com coordenadas de ate 32 bits, d tem ate 63 bits e x, y ate 95
+    struct RationalPoint {
+        int128_t x, y, d;
+    };
+
+    // ordem lexicografica (x, depois y) dos eventos da varredura
+    struct LexLess {
+        bool operator()(const RationalPoint& a, const RationalPoint& b) const {
+            int c = compareProducts(a.x, b.d, b.x, a.d);
+            return c != 0 ? c < 0 : compareProducts(a.y, b.d, b.y, a.d) < 0;
+        }
+    };
+
+    // inteiro mais proximo de x / d (d > 0), com os empates para cima
+    int64_t roundDiv(int128_t x, int128_t d) {
+        int128_t twice = 2 * x + d, q = twice / (2 * d);
+        if (twice % (2 * d) != 0 && twice < 0) {
+            q--;
+        }
+        return (int64_t)q;
+    }
+
+    // sentinela das buscas pelo ponto atual no estado da varredura
+    struct Probe {};
+
+    // trecho entre dois vertices (u antes de v) sobre a reta de uma aresta de
+    // entrada, que passa por (px, py) com direcao (dx, dy), e as faces de cada
+    // malha dos dois lados: face[malha][0 a esquerda de u -> v, 1 a direita]
+    struct Piece {
+        uint32_t u, v;
+        int64_t px, py;
+        int64_t dx, dy;
+        uint32_t face[2][2];
+    };
+
+    // aresta de uma das malhas, com p antes de q na ordem lexicografica. as faces
+    // ficam indexadas pela malha: own da propria (acima = a esquerda de p -> q,
+    // abaixo = a direita) e other da outra, atualizadas a cada trecho
+    template <typename Coord>
+    struct Segment {
+        BasicPoint<Coord> p, q;
+        int map;
+        uint32_t own[2];
+        uint32_t other[2];
+        uint32_t last;      // vertice do resultado onde comecou o trecho atual
+    };
+
+    template <typename Coord>
+    class OverlaySweep {
+    public:
+        // vertices do arranjo exato (entrada e cruzamentos) e os trechos entre eles;
+        // acima de um trecho eh a esquerda de u -> v
+        std::vector<RationalPoint> vertices;
+        std::vector<Piece> pieces;
+        size_t crossings = 0;
+        size_t rounded = 0;
+
+        OverlaySweep() : status(StatusOrder{this}) {}
+
+        void addSegments(const BasicDCEL<Coord>& dcel, int map);
+        void run();
+
+    private:
+        using Point = BasicPoint<Coord>;
+
+        // ordem vertical dos segmentos ativos no ponto atual; os que passam pelo
+        // ponto sao ordenados pela direcao logo depois dele
+        struct StatusOrder {
+            using is_transparent = void;
+            const OverlaySweep* sweep;
+
+            bool operator()(uint32_t a, uint32_t b) const { return sweep->below(a, b); }
+            bool operator()(uint32_t a, Probe) const { return sweep->side(a) > 0; }
+            bool operator()(Probe, uint32_t b) const { return sweep->side(b) < 0; }
+        };
+
+        std::vector<Segment<Coord>> segments;
+        uint32_t outer[2] = {0, 0};
+        RationalPoint current{0, 0, 1};
+        std::map<RationalPoint, std::vector<uint32_t>, LexLess> events;
+        std::set<uint32_t, StatusOrder> status;
+
+        static int128_t cross(int128_t ax, int128_t ay, int128_t bx, int128_t by) {
+            return ax * by - ay * bx;
+        }
+        int128_t directionCross(uint32_t a, uint32_t b) const;
+        int side(uint32_t s) const;
+        bool below(uint32_t a, uint32_t b) const;
+        bool endsHere(uint32_t s) const;
+        void checkCrossing(uint32_t a, uint32_t b);
+        void updateFaces(typename std::set<uint32_t, StatusOrder>::iterator it);
+        void handleEvent(const std::vector<uint32_t>& starts);
+    };
+
+    template <typename Coord>
+    void OverlaySweep<Coord>::addSegments(const BasicDCEL<Coord>& dcel, int map) {
+        for (uint32_t he = 0; he < dcel.getHalfEdgeCount(); he++) {
+            uint32_t twin = dcel.twin(he);
+            if (twin == NONE || twin < he) continue;
+
+            Segment<Coord> s;
+            s.p = dcel.segmentStart(he);
+            s.q = dcel.segmentEnd(he);
+            s.map = map;
+            s.own[0] = dcel.incidentFace(he);
+            s.own[1] = dcel.incidentFace(twin);
+            if (s.q.x < s.p.x || (s.q.x == s.p.x && s.q.y < s.p.y)) {
+                std::swap(s.p, s.q);
+                std::swap(s.own[0], s.own[1]);
+            }
+            s.other[0] = s.other[1] = NONE;
+            s.last = NONE;
+
+            uint32_t id = (uint32_t)segments.size();
+            segments.push_back(s);
+            events[RationalPoint{s.p.x, s.p.y, 1}].push_back(id);
+            events[RationalPoint{s.q.x, s.q.y, 1}];
+        }
+
+        // face externa: abaixo da aresta mais baixa que sai do menor vertice
+        // (todas saem para a direita e a semirreta para baixo nao cruza nada)
+        uint32_t first = NONE;
+        for (uint32_t v = 0; v < dcel.getVertexCount(); v++) {
+            if (dcel.incidentEdge(v) == NONE) continue;
+            Point p = dcel.vertexPosition(v), best = first != NONE ? dcel.vertexPosition(first) : p;
+            if (first == NONE || p.x < best.x || (p.x == best.x && p.y < best.y)) {
+                first = v;
+            }
+        }
+        if (first == NONE) return;
+        uint32_t lowest = NONE;
+        Point origin = dcel.vertexPosition(first);
+        for (uint32_t he : dcel.vertexEdges(first)) {
+            Point to = dcel.segmentEnd(he);
+            if (lowest == NONE) {
+                lowest = he;
+                continue;
+            }
+            Point best = dcel.segmentEnd(lowest);
+            if (cross((int128_t)to.x - origin.x, (int128_t)to.y - origin.y,
+                      (int128_t)best.x - origin.x, (int128_t)best.y - origin.y) > 0) {
+                lowest = he;
+            }
+        }
+        outer[map] = dcel.incidentFace(dcel.twin(lowest));
+    }
+
+    template <typename Coord>
+    int128_t OverlaySweep<Coord>::directionCross(uint32_t a, uint32_t b) const {
+        const Segment<Coord>& sa = segments[a];
+        const Segment<Coord>& sb = segments[b];
+        return cross((int128_t)sa.q.x - sa.p.x, (int128_t)sa.q.y - sa.p.y,
+                     (int128_t)sb.q.x - sb.p.x, (int128_t)sb.q.y - sb.p.y);
+    }
+
+    // lado do ponto atual em relacao a s: 1 acima, -1 abaixo, 0 sobre s
+    template <typename Coord>
+    int OverlaySweep<Coord>::side(uint32_t s) const {
+        const Segment<Coord>& seg = segments[s];
+        if (current.d == 1) {
+            // Geometry::orientation devolve HORARIO quando o ponto fica a esquerda
+            switch (Geometry::orientation(seg.p, seg.q, Point((Coord)current.x, (Coord)current.y))) {
+                case Geometry::Orientation::HORARIO: return 1;
+                case Geometry::Orientation::ANTIHORARIO: return -1;
+                default: return 0;
+            }
+        }
+        return compareProducts((int128_t)seg.q.x - seg.p.x, current.y - (int128_t)seg.p.y * current.d,
+                               (int128_t)seg.q.y - seg.p.y, current.x - (int128_t)seg.p.x * current.d);
+    }
+
+    template <typename Coord>
+    bool OverlaySweep<Coord>::below(uint32_t a, uint32_t b) const {
+        // a insercao so compara o segmento novo, que passa pelo ponto atual, com
+        // os ativos; os que passam pelo ponto foram retirados antes
+        int sideA = side(a), sideB = side(b);
+        if (sideA == 0 && sideB == 0) {
+            int128_t c = directionCross(a, b);
+            return c != 0 ? c > 0 : a < b;
+        }
+        if (sideB == 0) {
+            return sideA > 0;
+        }
+        if (sideA == 0) {
+            return sideB < 0;
+        }
+        return a < b;
+    }
+
+    template <typename Coord>
+    bool OverlaySweep<Coord>::endsHere(uint32_t s) const {
+        return current.d == 1 && segments[s].q.x == current.x && segments[s].q.y == current.y;
+    }
+
+    template <typename Coord>
+    void OverlaySweep<Coord>::checkCrossing(uint32_t a, uint32_t b) {
+        const Segment<Coord>& sa = segments[a];
+        const Segment<Coord>& sb = segments[b];
+        // arestas da mesma malha so se tocam nos vertices, que ja sao eventos
+        if (sa.map == sb.map) return;
+
+        int128_t dx = (int128_t)sa.q.x - sa.p.x, dy = (int128_t)sa.q.y - sa.p.y;
+        int128_t d = directionCross(a, b);
+        if (d == 0) return;  // paralelas: trechos colineares surgem pelos extremos
+        bool touching = sa.p == sb.p || sa.p == sb.q || sa.q == sb.p || sa.q == sb.q;
+        if (touching || !Geometry::segmentsIntersect(sa.p, sa.q, sb.p, sb.q)) return;
+
+        // p + t (q - p), com t = cross(sb.p - sa.p, sb) / cross(sa, sb)
+        int128_t t = cross((int128_t)sb.p.x - sa.p.x, (int128_t)sb.p.y - sa.p.y,
+                           (int128_t)sb.q.x - sb.p.x, (int128_t)sb.q.y - sb.p.y);
+        RationalPoint point{(int128_t)sa.p.x * d + t * dx, (int128_t)sa.p.y * d + t * dy, d};
+        if (point.d < 0) {
+            point.x = -point.x;
+            point.y = -point.y;
+            point.d = -point.d;
+        }
+        if (LexLess()(current, point)) {
+            events[point];
+        }
+    }
+
+    template <typename Coord>
+    void OverlaySweep<Coord>::updateFaces(typename std::set<uint32_t, StatusOrder>::iterator it) {
+        Segment<Coord>& s = segments[*it];
+
+        // trecho colinear com uma aresta da outra malha (vizinha pelo desempate):
+        // as faces dela dos dois lados
+        for (auto neighbor : {it == status.begin() ? status.end() : std::prev(it), std::next(it)}) {
+            if (neighbor == status.end()) continue;
+            const Segment<Coord>& t = segments[*neighbor];
+            if (t.map != s.map && side(*neighbor) == 0 && directionCross(*it, *neighbor) == 0) {
+                s.other[0] = t.own[0];
+                s.other[1] = t.own[1];
+                return;
+            }
+        }
+
+        // senao o trecho esta no interior de uma face da outra malha: a que fica
+        // logo acima do vizinho de baixo, ou a externa sem vizinho
+        uint32_t face = outer[1 - s.map];
+        if (it != status.begin()) {
+            const Segment<Coord>& t = segments[*std::prev(it)];
+            face = t.map != s.map ? t.own[0] : t.other[0];
+        }
+        s.other[0] = s.other[1] = face;
+    }
+
+    template <typename Coord>
+    void OverlaySweep<Coord>::handleEvent(const std::vector<uint32_t>& starts) {
+        auto first = status.lower_bound(Probe());
+        auto last = status.upper_bound(Probe());
+        std::vector<uint32_t> through(first, last);
+        if (through.empty() && starts.empty()) {
+            return;
+        }
+
+        // vertice do arranjo exato; o arredondamento fica para depois da varredura
+        uint32_t vertex = (uint32_t)vertices.size();
+        vertices.push_back(current);
+        if (current.x % current.d != 0 || current.y % current.d != 0) {
+            rounded++;
+        }
+
+        // fecha o trecho de cada segmento que passa por aqui
+        bool inputVertex = !starts.empty();
+        std::vector<uint32_t> continuing;
+        for (uint32_t s : through) {
+            Segment<Coord>& seg = segments[s];
+            Piece piece;
+            piece.u = seg.last;
+            piece.v = vertex;
+            piece.px = seg.p.x;
+            piece.py = seg.p.y;
+            piece.dx = (int64_t)seg.q.x - seg.p.x;
+            piece.dy = (int64_t)seg.q.y - seg.p.y;
+            piece.face[seg.map][0] = seg.own[0];
+            piece.face[seg.map][1] = seg.own[1];
+            piece.face[1 - seg.map][0] = seg.other[0];
+            piece.face[1 - seg.map][1] = seg.other[1];
+            pieces.push_back(piece);
+            seg.last = vertex;
+            if (endsHere(s)) {
+                inputVertex = true;
+            } else {
+                continuing.push_back(s);
+            }
+        }
+        if (!inputVertex) {
+            crossings++;
+        }
+
+        // os que continuam e os que comecam voltam na ordem logo depois do ponto
+        auto lower = first == status.begin() ? status.end() : std::prev(first);
+        status.erase(first, last);
+        for (uint32_t s : starts) {
+            segments[s].last = vertex;
+            continuing.push_back(s);
+        }
+        if (continuing.empty()) {
+            if (lower != status.end() && std::next(lower) != status.end()) {
+                checkCrossing(*lower, *std::next(lower));
+            }
+            return;
+        }
+        for (uint32_t s : continuing) {
+            status.insert(s);
+        }
+
+        // de baixo para cima: cada um depende do vizinho de baixo
+        first = status.lower_bound(Probe());
+        last = status.upper_bound(Probe());
+        for (auto it = first; it != last; ++it) {
+            updateFaces(it);
+        }
+        if (first != status.begin()) {
+            checkCrossing(*std::prev(first), *first);
+        }
+        if (last != status.end()) {
+            checkCrossing(*std::prev(last), *last);
+        }
+    }
+
+    template <typename Coord>
+    void OverlaySweep<Coord>::run() {
+        while (!events.empty()) {
+            auto next = events.begin();
+            current = next->first;
+            std::vector<uint32_t> starts;
+            starts.swap(next->second);
+            events.erase(next);
+            handleEvent(starts);
+        }
+    }
+
+    // quadrante da direcao (0 a 3, anti-horario a partir de +x), para ordenar angulos
+    int quadrant(int64_t dx, int64_t dy) {
+        if (dy == 0) return dx > 0 ? 0 : 2;
+        if (dx == 0) return dy > 0 ? 1 : 3;
+        return dy > 0 ? (dx > 0 ? 0 : 1) : (dx < 0 ? 2 : 3);
+    }
+
+    // extremo num / den (den > 0) de um intervalo de parametros sobre a reta de um
+    // trecho, aberto ou fechado
+    struct Bound {
+        int128_t num, den;
+        bool closed;
+    };
+
+    Bound makeBound(int128_t num, int128_t den, bool closed) {
+        return den < 0 ? Bound{-num, -den, closed} : Bound{num, den, closed};
+    }
+
+    int compareBounds(const Bound& a, const Bound& b) {
+        return compareProducts(a.num, b.den, b.num, a.den);
+    }
+
+    // parametro t de w = p + t (dx, dy), exato pelo eixo de maior variacao porque
+    // w esta sobre a reta
+    Bound parameterOf(const RationalPoint& w, const Piece& piece) {
+        if ((piece.dx < 0 ? -piece.dx : piece.dx) >= (piece.dy < 0 ? -piece.dy : piece.dy)) {
+            return makeBound(w.x - (int128_t)piece.px * w.d, (int128_t)piece.dx * w.d, true);
+        }
+        return makeBound(w.y - (int128_t)piece.py * w.d, (int128_t)piece.dy * w.d, true);
+    }
+
+    // restringe [low, high] aos t em que a coordenada p + t d cai em [h - 1/2,
+    // h + 1/2), o lado do pixel de centro h no eixo, semiaberto como em roundDiv
+    void clipToPixel(int64_t p, int64_t d, int64_t h, Bound& low, Bound& high) {
+        if (d == 0) {
+            if (p != h) {
+                low = Bound{1, 1, false};
+                high = Bound{0, 1, false};
+            }
+            return;
+        }
+        Bound first = makeBound(2 * (int128_t)h - 1 - 2 * (int128_t)p, 2 * (int128_t)d, true);
+        Bound last = makeBound(2 * (int128_t)h + 1 - 2 * (int128_t)p, 2 * (int128_t)d, false);
+        Bound enter = d > 0 ? first : last, leave = d > 0 ? last : first;
+        int c = compareBounds(enter, low);
+        if (c > 0 || (c == 0 && !enter.closed)) {
+            low = enter;
+        }
+        c = compareBounds(leave, high);
+        if (c < 0 || (c == 0 && !leave.closed)) {
+            high = leave;
+        }
+    }
+
+    // ordem de dois trechos que vao do pixel P ao pixel Q (centros inteiros) de um
+    // lado a outro do corredor entre eles: > 0 com f a esquerda de g no sentido
+    // P -> Q. a mediatriz de PQ separa os dois pixels e nenhum vertice fica entre
+    // eles, entao a ordem em que as retas a cruzam eh a dos trechos. com centro M e
+    // D = Q - P, a reta a + t e cruza em |D|^2 cross(2a - P - Q, e) / (2 e.D) ao
+    // longo de -D perpendicular, o que dispensa orientar e
+    int corridorOrder(const Piece& f, const Piece& g, int64_t px, int64_t py, int64_t qx, int64_t qy) {
+        int128_t Dx = (int128_t)qx - px, Dy = (int128_t)qy - py;
+        auto key = [&](const Piece& piece, int128_t& k, int128_t& eD) {
+            int128_t ax = 2 * (int128_t)piece.px - px - qx, ay = 2 * (int128_t)piece.py - py - qy;
+            k = ax * piece.dy - ay * piece.dx;
+            eD = piece.dx * Dx + piece.dy * Dy;
+            if (eD < 0) {
+                k = -k;
+                eD = -eD;
+            }
+        };
+        int128_t kf, ef, kg, eg;
+        key(f, kf, ef);
+        key(g, kg, eg);
+        int c = compareProducts(kg, ef, kf, eg);
+        if (c != 0) {
+            return c;
+        }
+
+        // as duas retas cruzam a mediatriz no mesmo ponto V, um vertice que so pode
+        // estar em P (os trechos saem de V) ou em Q (chegam a V); direcoes de P a Q
+        int sf = f.dx * Dx + f.dy * Dy > 0 ? 1 : -1, sg = g.dx * Dx + g.dy * Dy > 0 ? 1 : -1;
+        int128_t fx = sf * f.dx, fy = sf * f.dy, gx = sg * g.dx, gy = sg * g.dy;
+        int128_t ax = 2 * (int128_t)f.px - px - qx, ay = 2 * (int128_t)f.py - py - qy;
+        int128_t aD = ax * Dx + ay * Dy;
+        bool leaving = roundDiv(2 * (int128_t)f.px * ef - aD * fx, 2 * ef) == px &&
+                       roundDiv(2 * (int128_t)f.py * ef - aD * fy, 2 * ef) == py;
+        int turn = signOf(fx * gy - fy * gx);
+        return leaving ? -turn : turn;
+    }
+
+    // leques das half-edges 2i (u -> v) e 2i + 1 (v -> u) de cada aresta, agrupadas
+    // pela origem e em ordem angular
+    struct Fans {
+        std::vector<uint32_t> start, fan, position;
+
+        uint32_t origin(const std::vector<Piece>& edges, uint32_t he) const {
+            return he % 2 == 0 ? edges[he / 2].u : edges[he / 2].v;
+        }
+
+        void build(const std::vector<Piece>& edges, size_t vertices) {
+            size_t halfEdges = 2 * edges.size();
+            start.assign(vertices + 1, 0);
+            for (uint32_t he = 0; he < halfEdges; he++) {
+                start[origin(edges, he) + 1]++;
+            }
+            for (size_t v = 0; v < vertices; v++) {
+                start[v + 1] += start[v];
+            }
+            fan.resize(halfEdges);
+            std::vector<uint32_t> fill(start.begin(), start.end() - 1);
+            for (uint32_t he = 0; he < halfEdges; he++) {
+                fan[fill[origin(edges, he)]++] = he;
+            }
+            auto directionOf = [&](uint32_t he, int64_t& dx, int64_t& dy) {
+                int64_t sign = he % 2 == 0 ? 1 : -1;
+                dx = sign * edges[he / 2].dx;
+                dy = sign * edges[he / 2].dy;
+            };
+            position.resize(halfEdges);
+            for (size_t v = 0; v < vertices; v++) {
+                std::sort(fan.begin() + start[v], fan.begin() + start[v + 1], [&](uint32_t x, uint32_t y) {
+                    int64_t xdx, xdy, ydx, ydy;
+                    directionOf(x, xdx, xdy);
+                    directionOf(y, ydx, ydy);
+                    int qx = quadrant(xdx, xdy), qy = quadrant(ydx, ydy);
+                    return qx != qy ? qx < qy : (int128_t)xdx * ydy - (int128_t)xdy * ydx > 0;
+                });
+                for (uint32_t i = start[v]; i < start[v + 1]; i++) {
+                    position[fan[i]] = i;
+                }
+            }
+        }
+
+        // proxima no ciclo da face a esquerda: a que sai do destino logo antes (no
+        // sentido horario) da volta
+        uint32_t next(const std::vector<Piece>& edges, uint32_t he) const {
+            uint32_t back = he ^ 1;
+            uint32_t v = origin(edges, back);
+            uint32_t i = position[back];
+            return fan[i == start[v] ? start[v + 1] - 1 : i - 1];
+        }
+    };
+
+    // arredondamento com pixels quentes (Hobby): todo pixel que contem um vertice
+    // do arranjo exato vira um vertice, e cada trecho passa a ligar os centros dos
+    // pixels quentes que atravessa, na ordem da reta. o resultado nao tem
+    // cruzamentos, mas trechos vizinhos podem coincidir e faces estreitas somem:
+    // entre os trechos que ligam os mesmos dois pixels, as faces do resultado sao
+    // as de fora dos mais externos, e as de dentro (achatadas) desaparecem. sem
+    // vertices fora de pontos inteiros (moved falso) nada se move e o arranjo
+    // exato ja eh o resultado, sem desviar trechos para pixels vizinhos
+    void snapRound(const std::vector<RationalPoint>& exact, const std::vector<Piece>& pieces, bool moved,
+                   std::vector<int64_t>& pixelX, std::vector<int64_t>& pixelY,
+                   std::vector<Piece>& edges) {
+        // pixels quentes, numerados na ordem das coordenadas
+        std::vector<int64_t> roundedX(exact.size()), roundedY(exact.size());
+        std::vector<uint32_t> order(exact.size());
+        for (uint32_t v = 0; v < exact.size(); v++) {
+            roundedX[v] = roundDiv(exact[v].x, exact[v].d);
+            roundedY[v] = roundDiv(exact[v].y, exact[v].d);
+            order[v] = v;
+        }
+        std::sort(order.begin(), order.end(), [&](uint32_t x, uint32_t y) {
+            return roundedX[x] != roundedX[y] ? roundedX[x] < roundedX[y] : roundedY[x] < roundedY[y];
+        });
+        std::vector<uint32_t> pixelOf(exact.size());
+        pixelX.clear();
+        pixelY.clear();
+        for (size_t i = 0; i < order.size(); i++) {
+            uint32_t v = order[i];
+            if (i == 0 || roundedX[v] != pixelX.back() || roundedY[v] != pixelY.back()) {
+                pixelX.push_back(roundedX[v]);
+                pixelY.push_back(roundedY[v]);
+            }
+            pixelOf[v] = (uint32_t)pixelX.size() - 1;
+        }
+
+        // pixels quentes atravessados por cada trecho, fora os dos seus extremos:
+        // a grade guarda os trechos entre os pixels dos extremos, a menos de um
+        // pixel do trecho exato, e cada pixel consulta a vizinhanca
+        struct Visit {
+            uint32_t piece, pixel;
+            Bound enter;
+        };
+        std::vector<Visit> visits;
+        SegmentGrid grid;
+        std::vector<Bound> start, end;
+        if (moved) {
+            grid.build(*std::min_element(pixelX.begin(), pixelX.end()),
+                       *std::min_element(pixelY.begin(), pixelY.end()),
+                       *std::max_element(pixelX.begin(), pixelX.end()),
+                       *std::max_element(pixelY.begin(), pixelY.end()), pieces.size());
+            start.resize(pieces.size());
+            end.resize(pieces.size());
+            for (uint32_t i = 0; i < pieces.size(); i++) {
+                const Piece& piece = pieces[i];
+                grid.insert(i, pixelX[pixelOf[piece.u]], pixelY[pixelOf[piece.u]],
+                            pixelX[pixelOf[piece.v]], pixelY[pixelOf[piece.v]]);
+                start[i] = parameterOf(exact[piece.u], piece);
+                end[i] = parameterOf(exact[piece.v], piece);
+            }
+        }
+        std::vector<uint32_t> nearby;
+        for (uint32_t h = 0; moved && h < pixelX.size(); h++) {
+            grid.query(pixelX[h] - 1, pixelY[h] - 1, pixelX[h] + 1, pixelY[h] + 1, nearby);
+            for (uint32_t i : nearby) {
+                const Piece& piece = pieces[i];
+                if (pixelOf[piece.u] == h || pixelOf[piece.v] == h) continue;
+                Bound low = start[i], high = end[i];
+                clipToPixel(piece.px, piece.dx, pixelX[h], low, high);
+                clipToPixel(piece.py, piece.dy, pixelY[h], low, high);
+                int c = compareBounds(low, high);
+                if (c < 0 || (c == 0 && low.closed && high.closed)) {
+                    visits.push_back(Visit{i, h, low});
+                }
+            }
+        }
+        // os pixels sao disjuntos, entao os intervalos de cada um sobre a reta tambem;
+        // um pixel tocado so num ponto (quina) pode comecar no mesmo t em que o
+        // seguinte comeca aberto, e o fechado vem antes
+        std::sort(visits.begin(), visits.end(), [](const Visit& x, const Visit& y) {
+            if (x.piece != y.piece) {
+                return x.piece < y.piece;
+            }
+            int c = compareBounds(x.enter, y.enter);
+            return c != 0 ? c < 0 : x.enter.closed && !y.enter.closed;
+        });
+
+        // trechos entre pixels consecutivos, orientados do pixel menor ao maior
+        struct Fragment {
+            uint32_t from, to, piece;
+            bool reversed;
+        };
+        std::vector<Fragment> fragments;
+        auto addFragment = [&](uint32_t piece, uint32_t from, uint32_t to) {
+            if (from < to) fragments.push_back(Fragment{from, to, piece, false});
+            else if (from > to) fragments.push_back(Fragment{to, from, piece, true});
+        };
+        size_t next = 0;
+        for (uint32_t i = 0; i < pieces.size(); i++) {
+            uint32_t from = pixelOf[pieces[i].u];
+            for (; next < visits.size() && visits[next].piece == i; next++) {
+                addFragment(i, from, visits[next].pixel);
+                from = visits[next].pixel;
+            }
+            addFragment(i, from, pixelOf[pieces[i].v]);
+        }
+
+        // cada par de pixels vira uma aresta, com as faces de fora dos trechos
+        // mais externos do corredor
+        std::sort(fragments.begin(), fragments.end(), [&](const Fragment& x, const Fragment& y) {
+            if (x.from != y.from || x.to != y.to) {
+                return x.from != y.from ? x.from < y.from : x.to < y.to;
+            }
+            return corridorOrder(pieces[x.piece], pieces[y.piece], pixelX[x.from], pixelY[x.from],
+                                 pixelX[x.to], pixelY[x.to]) > 0;
+        });
+        edges.clear();
+        for (size_t i = 0; i < fragments.size();) {
+            size_t j = i;
+            while (j < fragments.size() && fragments[j].from == fragments[i].from &&
+                   fragments[j].to == fragments[i].to) {
+                j++;
+            }
+            const Fragment& left = fragments[i];
+            const Fragment& right = fragments[j - 1];
+            Piece edge;
+            edge.u = left.from;
+            edge.v = left.to;
+            edge.px = pixelX[edge.u];
+            edge.py = pixelY[edge.u];
+            edge.dx = pixelX[edge.v] - edge.px;
+            edge.dy = pixelY[edge.v] - edge.py;
+            for (int map = 0; map < 2; map++) {
+                edge.face[map][0] = pieces[left.piece].face[map][left.reversed ? 1 : 0];
+                edge.face[map][1] = pieces[right.piece].face[map][right.reversed ? 0 : 1];
+            }
+            edges.push_back(edge);
+            i = j;
+        }
+    }
+}
+
+template <typename Coord>
+bool BasicMapOverlay<Coord>::build(const BasicDCEL<Coord>& a, const BasicDCEL<Coord>& b,
+                                   BasicDCEL<Coord>& result) {
+    // com 64 bits os cruzamentos nao cabem na aritmetica de 256 bits
+    if (sizeof(Coord) > sizeof(int32_t)) {
+        fprintf(stderr, "erro: sobreposicao de mapas suporta coordenadas de ate 32 bits\n");
+        return false;
+    }
+    if (a.validate() != DCELBase::Verdict::VALID || b.validate() != DCELBase::Verdict::VALID) {
+        fprintf(stderr, "erro: sobreposicao de mapas exige duas malhas validas\n");
+        return false;
+    }
+
+    OverlaySweep<Coord> sweep;
+    sweep.addSegments(a, 0);
+    sweep.addSegments(b, 1);
+    sweep.run();
+    crossings = sweep.crossings;
+    rounded = sweep.rounded;
+
+    // trechos colineares das duas malhas aparecem duas vezes, com as mesmas faces
+    std::vector<Piece>& pieces = sweep.pieces;
+    std::sort(pieces.begin(), pieces.end(), [](const Piece& x, const Piece& y) {
+        return x.u != y.u ? x.u < y.u : x.v < y.v;
+    });
+    pieces.erase(std::unique(pieces.begin(), pieces.end(), [](const Piece& x, const Piece& y) {
+        return x.u == y.u && x.v == y.v;
+    }), pieces.end());
+
+    std::vector<int64_t> pixelX, pixelY;
+    std::vector<Piece> edges;
+    snapRound(sweep.vertices, pieces, rounded > 0, pixelX, pixelY, edges);
+
+    // arestas com a mesma face dos dois lados sobram de faces achatadas (antenas
+    // e pontes); saem ate nao restar nenhuma, sem mudar as demais faces
+    Fans fans;
+    std::vector<uint32_t> cycleOf;
+    for (;;) {
+        fans.build(edges, pixelX.size());
+        cycleOf.assign(2 * edges.size(), NONE);
+        uint32_t cycles = 0;
+        for (uint32_t start = 0; start < cycleOf.size(); start++) {
+            if (cycleOf[start] != NONE) continue;
+            uint32_t he = start;
+            do {
+                cycleOf[he] = cycles;
+                he = fans.next(edges, he);
+            } while (he != start);
+            cycles++;
+        }
+        size_t kept = 0;
+        for (size_t i = 0; i < edges.size(); i++) {
+            if (cycleOf[2 * i] != cycleOf[2 * i + 1]) {
+                edges[kept++] = edges[i];
+            }
+        }
+        if (kept == edges.size()) break;
+        edges.resize(kept);
+    }
+
+    // cada ciclo eh uma face, a esquerda das suas half-edges. um ciclo que passa
+    // duas vezes pelo mesmo vertice (face estrangulada no arredondamento) vira
+    // uma face por laco, com as mesmas faces de origem
+    MeshData mesh;
+    mesh.faceStart.push_back(0);
+    sourceFace[0].clear();
+    sourceFace[1].clear();
+    std::vector<uint32_t> newVertex(pixelX.size(), NONE);
+    std::vector<uint32_t> walkAt(pixelX.size(), NONE);
+    std::vector<uint32_t> walk;
+    std::vector<bool> visited(2 * edges.size(), false);
+    bool consistent = true;
+    auto emitFace = [&](size_t from) {
+        uint32_t first = walk[from];
+        sourceFace[0].push_back(edges[first / 2].face[0][first % 2]);
+        sourceFace[1].push_back(edges[first / 2].face[1][first % 2]);
+        for (size_t i = from; i < walk.size(); i++) {
+            uint32_t he = walk[i];
+            uint32_t v = fans.origin(edges, he);
+            walkAt[v] = NONE;
+            for (int map = 0; map < 2; map++) {
+                consistent &= edges[he / 2].face[map][he % 2] == sourceFace[map].back();
+            }
+            if (newVertex[v] == NONE) {
+                newVertex[v] = (uint32_t)mesh.vertexX.size();
+                mesh.vertexX.push_back(pixelX[v]);
+                mesh.vertexY.push_back(pixelY[v]);
+            }
+            mesh.faceVertices.push_back((int)newVertex[v] + 1);
+        }
+        mesh.faceStart.push_back(mesh.faceVertices.size());
+        walk.resize(from);
+    };
+    for (uint32_t start = 0; start < visited.size(); start++) {
+        if (visited[start]) continue;
+        uint32_t he = start;
+        do {
+            visited[he] = true;
+            uint32_t v = fans.origin(edges, he);
+            if (walkAt[v] != NONE) {
+                emitFace(walkAt[v]);
+            }
+            walkAt[v] = (uint32_t)walk.size();
+            walk.push_back(he);
+            he = fans.next(edges, he);
+        } while (he != start);
+        emitFace(0);
+    }
+
+    // as faces de origem de cada ciclo vem das arestas mais externas de cada
+    // corredor, entao concordam ao longo dele; a conferencia fica como defesa
+    if (!consistent) {
+        fprintf(stderr, "erro: sobreposicao de mapas: faces de origem inconsistentes apos o arredondamento\n");
+        return false;
+    }
+    if (!result.loadFromMesh(mesh)) {
+        return false;
+    }
+    DCELBase::Verdict verdict = result.validate();
+    if (verdict != DCELBase::Verdict::VALID) {
+        fprintf(stderr, "erro: sobreposicao de mapas: resultado %s apos o arredondamento\n",
+                DCELBase::verdictName(verdict));
+        return false;
+    }
+    return true;
+}
+
+// instancias para cada largura de coordenada (coordinate.h); a de 64 bits so recusa
+template class BasicMapOverlay<int16_t>;
+template class BasicMapOverlay<int32_t>;
+template class BasicMapOverlay<int64_t>;
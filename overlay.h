@@ -0,0 +1,56 @@
+#ifndef OVERLAY_H
+#define OVERLAY_H
+
+#include "DCEL.h"
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// sobreposicao de duas subdivisoes validas (overlay.cpp): o refinamento comum,
+// com um vertice em cada vertice de entrada e em cada cruzamento de arestas, e
+// as arestas das duas divididas nesses pontos (trechos colineares das duas viram
+// uma aresta so). uma varredura de Bentley-Ottmann sobre as arestas das duas
+// malhas encontra os cruzamentos em O((n + k) log n), com os testes de lado
+// exatos: Geometry::orientation para pontos inteiros e aritmetica racional de
+// 256 bits para os cruzamentos. a mesma varredura anota, em cada lado de cada
+// trecho, a face de cada malha de entrada, entao cada face do resultado sabe de
+// que face de cada mapa veio sem consultas de localizacao.
+//
+// quando algum cruzamento nao cai em ponto inteiro, o arranjo exato passa por
+// arredondamento com pixels quentes (Hobby): cada pixel que contem um vertice
+// vira o vertice inteiro do seu centro e cada trecho passa pelos centros dos
+// pixels quentes que atravessa. o resultado nao ganha cruzamentos novos, mas
+// faces mais estreitas que um pixel podem sumir, e uma face estrangulada num
+// vertice vira uma face por laco. build confere as faces de origem e valida o
+// resultado, e devolve false se algo nao fechar. as faces seguem o modelo da
+// DCEL, um ciclo por face: uma malha contida no interior de uma face da outra,
+// sem tocar suas arestas, produz uma face a mais (o contorno do buraco, com
+// area negativa). suporta coordenadas de ate 32 bits; com int64_t build recusa
+// as malhas
+template <typename Coord>
+class BasicMapOverlay {
+public:
+    using Point = BasicPoint<Coord>;
+
+    // a e b precisam ser validas; result eh reconstruida com loadFromMesh e
+    // so vale quando build devolve true
+    bool build(const BasicDCEL<Coord>& a, const BasicDCEL<Coord>& b, BasicDCEL<Coord>& result);
+
+    // face (0-based) de a e de b que contem a face f do resultado
+    uint32_t faceOfA(uint32_t f) const { return sourceFace[0][f]; }
+    uint32_t faceOfB(uint32_t f) const { return sourceFace[1][f]; }
+
+    // cruzamentos fora dos vertices de entrada e quantos cairam fora de pontos
+    // inteiros (com algum, o resultado passa pelo arredondamento)
+    size_t getCrossingCount() const { return crossings; }
+    size_t getRoundedCount() const { return rounded; }
+
+private:
+    std::vector<uint32_t> sourceFace[2];
+    size_t crossings = 0;
+    size_t rounded = 0;
+};
+
+using MapOverlay = BasicMapOverlay<int32_t>;
+
+#endif
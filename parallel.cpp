@@ -0,0 +1,324 @@
+#include "DCEL.h"
+#include "parser.h"
+#include "stats.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+// construcao paralela (setConstructionThreads): as faces sao divididas em
+// intervalos contiguos, um por thread, e cada etapa escreve em posicoes
+// calculadas antes por somas de prefixo, entao a numeracao das half-edges, os
+// twins e as cadeias saem iguais aos da construcao serial com qualquer numero
+// de threads
+
+namespace {
+    const uint32_t NONE = DCELBase::NONE;
+
+    // abaixo disso por thread o trabalho nao paga a criacao das threads
+    const size_t MIN_EDGES_PER_THREAD = 16384;
+
+    // baldes de arestas por thread no pareamento de twins, distribuidos sob
+    // demanda para compensar baldes maiores que outros
+    const size_t BUCKETS_PER_THREAD = 8;
+
+    // faces com ate tantas half-edges procuram a proxima por busca linear
+    const size_t SMALL_FACE = 16;
+
+    unsigned threadCount(unsigned requested, size_t work) {
+        if (requested == 0) {
+            requested = std::max(1u, std::thread::hardware_concurrency());
+        }
+        return (unsigned)std::min<size_t>(requested, work / MIN_EDGES_PER_THREAD + 1);
+    }
+
+    // work(t) em threads novas para t > 0 e na thread atual para t = 0
+    template <typename Work>
+    void runThreads(unsigned threads, const Work& work) {
+        std::vector<std::thread> workers;
+        for (unsigned t = 1; t < threads; t++) {
+            workers.emplace_back(work, t);
+        }
+        work(0);
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    // aresta geometrica normalizada (min, max) empacotada em 64 bits, como em DCEL.cpp
+    uint64_t edgeKey(uint32_t from, uint32_t to) {
+        return ((uint64_t)std::min(from, to) << 32) | std::max(from, to);
+    }
+
+    // guarda em slot o menor de seu valor e value, com outras threads escrevendo
+    void atomicMin(uint32_t* slot, uint32_t value) {
+        uint32_t current = __atomic_load_n(slot, __ATOMIC_RELAXED);
+        while (value < current &&
+               !__atomic_compare_exchange_n(slot, &current, value, true, __ATOMIC_RELAXED,
+                                            __ATOMIC_RELAXED)) {
+        }
+    }
+}
+
+template <typename Coord>
+void BasicDCEL<Coord>::createHalfEdgesParallel(const MeshData& mesh, std::vector<uint64_t>& keys) {
+    Stats::Timer timer(Stats::CREATE_HALF_EDGES);
+
+    size_t faces = faceEdge.size();
+    size_t vertices = vertexX.size();
+    unsigned threads = threadCount(constructionThreads, mesh.faceVertices.size());
+
+    // intervalos de faces com quantidades parecidas de indices de vertice
+    std::vector<size_t> faceBegin(threads + 1, faces);
+    for (unsigned t = 0; t < threads; t++) {
+        size_t target = mesh.faceVertices.size() / threads * t;
+        faceBegin[t] = std::lower_bound(mesh.faceStart.begin(), mesh.faceStart.end() - 1, target) -
+                       mesh.faceStart.begin();
+    }
+
+    // half-edge de cada par de vertices consecutivos de faces com 3 ou mais
+    // vertices, pulando indices fora da malha (mesma regra de addFaceHalfEdges)
+    auto forEachHalfEdge = [&](unsigned t, auto emit) {
+        for (size_t f = faceBegin[t]; f < faceBegin[t + 1]; f++) {
+            const int* faceVertices = mesh.faceVertices.data() + mesh.faceStart[f];
+            size_t numVertices = mesh.faceStart[f + 1] - mesh.faceStart[f];
+            if (numVertices < 3) {
+                continue;
+            }
+            for (size_t i = 0; i < numVertices; i++) {
+                int fromIdx = inputToInternal(faceVertices[i]);
+                int toIdx = inputToInternal(faceVertices[(i + 1) % numVertices]);
+                if (fromIdx < 0 || fromIdx >= (int)vertices || toIdx < 0 || toIdx >= (int)vertices) {
+                    continue;
+                }
+                emit((uint32_t)f, (uint32_t)fromIdx, (uint32_t)toIdx);
+            }
+        }
+    };
+
+    // contagem por thread e soma de prefixo: a primeira half-edge de cada thread
+    std::vector<size_t> edgeBegin(threads + 1, 0);
+    runThreads(threads, [&](unsigned t) {
+        size_t count = 0;
+        forEachHalfEdge(t, [&](uint32_t, uint32_t, uint32_t) { count++; });
+        edgeBegin[t + 1] = count;
+    });
+    for (unsigned t = 0; t < threads; t++) {
+        edgeBegin[t + 1] += edgeBegin[t];
+    }
+
+    size_t total = edgeBegin[threads];
+    edgeOrigin.assign(total, NONE);
+    edgeFace.assign(total, NONE);
+    keys.assign(total, 0);
+    uint32_t* origin = edgeOrigin.mutableData();
+    uint32_t* face = edgeFace.mutableData();
+    uint32_t* firstOfVertex = vertexEdge.mutableData();
+    uint32_t* firstOfFace = faceEdge.mutableData();
+
+    // cada thread escreve as proprias half-edges; a face tambem eh so dela, e o
+    // vertice fica com a menor half-edge que sai dele, como na ordem serial
+    runThreads(threads, [&](unsigned t) {
+        uint32_t he = (uint32_t)edgeBegin[t];
+        forEachHalfEdge(t, [&](uint32_t f, uint32_t from, uint32_t to) {
+            origin[he] = from;
+            face[he] = f;
+            keys[he] = edgeKey(from, to);
+            atomicMin(&firstOfVertex[from], he);
+            if (firstOfFace[f] == NONE) {
+                firstOfFace[f] = he;
+            }
+            he++;
+        });
+    });
+}
+
+template <typename Coord>
+void BasicDCEL<Coord>::matchTwinsParallel(std::vector<uint64_t>& keys) {
+    Stats::Timer timer(Stats::MATCH_TWINS);
+
+    size_t count = keys.size();
+    size_t vertices = std::max<size_t>(vertexX.size(), 1);
+    unsigned threads = threadCount(constructionThreads, count);
+    size_t buckets = threads * BUCKETS_PER_THREAD;
+
+    // baldes pelo menor vertice da aresta: half-edges da mesma aresta caem no
+    // mesmo balde, que pode ser ordenado e pareado sem ver os outros
+    auto bucketOf = [&](uint64_t key) { return (size_t)((key >> 32) * buckets / vertices); };
+
+    // histograma de cada thread sobre o proprio intervalo de half-edges; a
+    // posicao de cada uma no balde segue a ordem de criacao
+    size_t chunk = (count + threads - 1) / threads;
+    std::vector<size_t> position(threads * buckets, 0);
+    runThreads(threads, [&](unsigned t) {
+        size_t* histogram = &position[t * buckets];
+        for (size_t he = t * chunk; he < std::min(count, (t + 1) * chunk); he++) {
+            histogram[bucketOf(keys[he])]++;
+        }
+    });
+    std::vector<size_t> bucketBegin(buckets + 1, 0);
+    size_t offset = 0;
+    for (size_t b = 0; b < buckets; b++) {
+        bucketBegin[b] = offset;
+        for (unsigned t = 0; t < threads; t++) {
+            size_t c = position[t * buckets + b];
+            position[t * buckets + b] = offset;
+            offset += c;
+        }
+    }
+    bucketBegin[buckets] = offset;
+
+    std::vector<std::pair<uint64_t, uint32_t>> sorted(count);
+    runThreads(threads, [&](unsigned t) {
+        size_t* next = &position[t * buckets];
+        for (size_t he = t * chunk; he < std::min(count, (t + 1) * chunk); he++) {
+            sorted[next[bucketOf(keys[he])]++] = {keys[he], (uint32_t)he};
+        }
+    });
+    std::vector<uint64_t>().swap(keys);
+
+    edgeTwin.assign(edgeOrigin.size(), NONE);
+
+    // cada balde ordenado por (chave, half-edge) fica na mesma ordem da
+    // ordenacao estavel serial, e cada aresta so escreve os twins das suas
+    // half-edges; os vereditos sao juntados no fim
+    std::vector<uint32_t> order(count);
+    std::vector<std::vector<uint32_t>> sameDirection(threads);
+    std::vector<char> threadOpen(threads, 0), threadNonPlanar(threads, 0);
+    std::atomic<size_t> nextBucket(0);
+    runThreads(threads, [&](unsigned t) {
+        bool open = false, nonPlanar = false;
+        for (;;) {
+            size_t b = nextBucket.fetch_add(1, std::memory_order_relaxed);
+            if (b >= buckets) {
+                break;
+            }
+            size_t begin = bucketBegin[b], end = bucketBegin[b + 1];
+            std::sort(sorted.begin() + begin, sorted.begin() + end);
+            for (size_t i = begin; i < end; i++) {
+                order[i] = sorted[i].second;
+            }
+            while (begin < end) {
+                size_t groupEnd = begin + 1;
+                while (groupEnd < end && sorted[groupEnd].first == sorted[begin].first) {
+                    groupEnd++;
+                }
+                matchEdgeGroup(&order[begin], groupEnd - begin, open, nonPlanar, sameDirection[t]);
+                begin = groupEnd;
+            }
+        }
+        threadOpen[t] = open;
+        threadNonPlanar[t] = nonPlanar;
+    });
+
+    std::vector<uint32_t> sameDirectionOrigins;
+    for (unsigned t = 0; t < threads; t++) {
+        sameDirectionOrigins.insert(sameDirectionOrigins.end(), sameDirection[t].begin(),
+                                    sameDirection[t].end());
+    }
+    openEdges = std::count(threadOpen.begin(), threadOpen.end(), 1) > 0;
+    nonPlanarEdges = std::count(threadNonPlanar.begin(), threadNonPlanar.end(), 1) > 0 ||
+                     hasRepeatedOrigin(sameDirectionOrigins);
+}
+
+template <typename Coord>
+void BasicDCEL<Coord>::linkHalfEdgeChainsParallel() {
+    Stats::Timer timer(Stats::LINK_CHAINS);
+
+    size_t count = edgeOrigin.size();
+    unsigned threads = threadCount(constructionThreads, count);
+
+    // intervalos de half-edges ajustados ao inicio de uma face: as half-edges
+    // de uma face sao contiguas, entao cada face fica inteira em uma thread
+    std::vector<size_t> edgeBegin(threads + 1, count);
+    edgeBegin[0] = 0;
+    for (unsigned t = 1; t < threads; t++) {
+        size_t he = std::max(edgeBegin[t - 1], count / threads * t);
+        while (he > 0 && he < count && edgeFace[he] == edgeFace[he - 1]) {
+            he++;
+        }
+        edgeBegin[t] = he;
+    }
+
+    const uint32_t* origin = edgeOrigin.data();
+    const uint32_t* face = edgeFace.data();
+    uint32_t* nextOf = edgeNext.mutableData();
+    uint32_t* prevOf = edgePrev.mutableData();
+
+    runThreads(threads, [&](unsigned t) {
+        // memoria de trabalho por face, no lugar das tabelas por vertice da
+        // versao serial: (origem, half-edge) ordenados nas faces grandes e a
+        // marca de visita relativa ao inicio da face
+        std::vector<std::pair<uint32_t, uint32_t>> fromOrigin;
+        std::vector<char> visited;
+
+        size_t begin = edgeBegin[t];
+        while (begin < edgeBegin[t + 1]) {
+            uint32_t f = face[begin];
+            size_t end = begin;
+            while (end < count && face[end] == f) {
+                end++;
+            }
+            size_t size = end - begin;
+
+            // primeira half-edge da face que sai do vertice, ou NONE
+            if (size > SMALL_FACE) {
+                fromOrigin.resize(size);
+                for (size_t i = 0; i < size; i++) {
+                    fromOrigin[i] = {origin[begin + i], (uint32_t)(begin + i)};
+                }
+                std::sort(fromOrigin.begin(), fromOrigin.end());
+            }
+            auto firstFrom = [&](uint32_t vertex) {
+                if (size <= SMALL_FACE) {
+                    for (size_t he = begin; he < end; he++) {
+                        if (origin[he] == vertex) {
+                            return (uint32_t)he;
+                        }
+                    }
+                    return NONE;
+                }
+                auto it = std::lower_bound(fromOrigin.begin(), fromOrigin.end(),
+                                           std::make_pair(vertex, (uint32_t)0));
+                return it != fromOrigin.end() && it->first == vertex ? it->second : NONE;
+            };
+            visited.assign(size, 0);
+
+            // mesmo percurso de linkHalfEdgeChains, a partir do outerComponent
+            uint32_t start = faceEdge[f];
+            if (start < begin || start >= end) {
+                begin = end;
+                continue;
+            }
+            uint32_t current = start;
+            do {
+                visited[current - begin] = 1;
+
+                uint32_t next = NONE;
+                uint32_t targetVertex = destination(current);
+                if (targetVertex != NONE) {
+                    next = firstFrom(targetVertex);
+                }
+
+                nextOf[current] = next;
+                if (next != NONE) {
+                    prevOf[next] = current;
+                }
+                current = next;
+            } while (current != NONE && current != start && !visited[current - begin]);
+
+            begin = end;
+        }
+    });
+}
+
+// instancias para cada largura de coordenada (coordinate.h)
+#define INSTANTIATE_PARALLEL(Coord)                                                            \
+    template void BasicDCEL<Coord>::createHalfEdgesParallel(const MeshData&,                  \
+                                                            std::vector<uint64_t>&);          \
+    template void BasicDCEL<Coord>::matchTwinsParallel(std::vector<uint64_t>&);               \
+    template void BasicDCEL<Coord>::linkHalfEdgeChainsParallel();
+
+INSTANTIATE_PARALLEL(int16_t)
+INSTANTIATE_PARALLEL(int32_t)
+INSTANTIATE_PARALLEL(int64_t)
+#undef INSTANTIATE_PARALLEL
@@ -0,0 +1,273 @@
+#include "parser.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <cctype>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace {
+    // tamanho do buffer de leitura quando a entrada nao pode ser mapeada
+    const size_t READ_BLOCK = size_t(1) << 22;
+
+    // maior token valido: sinal, 19 digitos e o separador seguinte
+    const size_t MAX_TOKEN = 32;
+}
+
+bool MeshData::coordinateRange(int64_t& low, int64_t& high) const {
+    if (vertexX.empty()) {
+        return false;
+    }
+    auto [minX, maxX] = std::minmax_element(vertexX.begin(), vertexX.end());
+    auto [minY, maxY] = std::minmax_element(vertexY.begin(), vertexY.end());
+    low = std::min(*minX, *minY);
+    high = std::max(*maxX, *maxY);
+    return true;
+}
+
+void MeshData::clear() {
+    vertexX.clear();
+    vertexY.clear();
+    faceStart.clear();
+    faceVertices.clear();
+}
+
+MeshParser::~MeshParser() {
+    if (mapping) {
+        munmap(mapping, mappingSize);
+    }
+    if (ownsFd) {
+        close(sourceFd);
+    }
+}
+
+bool MeshParser::openFile(const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        error = std::string(path) + ": " + strerror(errno);
+        return false;
+    }
+    return mapFile(fd, true);
+}
+
+bool MeshParser::openStdin() {
+    // entrada redirecionada de arquivo tambem pode ser mapeada
+    return mapFile(STDIN_FILENO, false);
+}
+
+bool MeshParser::mapFile(int fd, bool owned) {
+    struct stat info;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        void* region = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (region != MAP_FAILED) {
+            if (owned) {
+                close(fd);
+            }
+            mapping = region;
+            mappingSize = (size_t)info.st_size;
+            madvise(mapping, mappingSize, MADV_SEQUENTIAL);
+            data = static_cast<const char*>(mapping);
+            size = mappingSize;
+            return true;
+        }
+    }
+
+    // pipes e terminais: le em blocos conforme a leitura avanca
+    sourceFd = fd;
+    ownsFd = owned;
+    buffer.resize(READ_BLOCK);
+    data = buffer.data();
+    return true;
+}
+
+bool MeshParser::refill() {
+    if (sourceFd < 0) {
+        return false;
+    }
+
+    // move o trecho ainda nao lido para o inicio do buffer
+    size_t remaining = size - position;
+    memmove(buffer.data(), buffer.data() + position, remaining);
+    position = 0;
+    size = remaining;
+
+    while (size < buffer.size()) {
+        ssize_t got = read(sourceFd, buffer.data() + size, buffer.size() - size);
+        if (got < 0) {
+            if (errno == EINTR) continue;
+            error = std::string("falha de leitura: ") + strerror(errno);
+            break;
+        }
+        if (got == 0) break;
+        size += (size_t)got;
+        // basta ter algo novo para continuar a leitura
+        break;
+    }
+    return size > remaining;
+}
+
+bool MeshParser::fail(const std::string& message) {
+    error = "linha " + std::to_string(line) + ": " + message;
+    return false;
+}
+
+bool MeshParser::skipWhitespace() {
+    // pula espacos e quebras de linha; false no fim da entrada
+    for (int c = peek(); c >= 0; c = peek()) {
+        if (c == '\n') {
+            line++;
+        } else if (c != ' ' && c != '\t' && c != '\r') {
+            return true;
+        }
+        position++;
+    }
+    return false;
+}
+
+bool MeshParser::readInt(int& value, const char* what) {
+    int64_t wide;
+    if (!readInt64(wide, what)) {
+        return false;
+    }
+    if (wide < INT_MIN || wide > INT_MAX) {
+        return fail(std::string(what) + " fora do intervalo de int");
+    }
+    value = (int)wide;
+    return true;
+}
+
+bool MeshParser::readInt64(int64_t& value, const char* what) {
+    // garante que o token inteiro esta no buffer
+    while (size - position < MAX_TOKEN && refill()) {
+    }
+
+    if (position >= size) {
+        return fail(std::string("fim da entrada, esperado inteiro para ") + what);
+    }
+
+    bool negative = false;
+    if (data[position] == '-' || data[position] == '+') {
+        negative = data[position] == '-';
+        position++;
+    }
+
+    // acumula sem sinal ate 2^63, o modulo do menor int64
+    const uint64_t LIMIT = uint64_t(1) << 63;
+    size_t begin = position;
+    uint64_t result = 0;
+    while (position < size && data[position] >= '0' && data[position] <= '9') {
+        uint64_t digit = (uint64_t)(data[position] - '0');
+        if (result > (LIMIT - digit) / 10) {
+            return fail(std::string(what) + " fora do intervalo de 64 bits");
+        }
+        result = result * 10 + digit;
+        position++;
+    }
+
+    if (position == begin) {
+        return fail(std::string("esperado inteiro para ") + what);
+    }
+    if (position < size && !isspace((unsigned char)data[position])) {
+        return fail(std::string("caractere invalido em ") + what);
+    }
+
+    if (!negative && result == LIMIT) {
+        return fail(std::string(what) + " fora do intervalo de 64 bits");
+    }
+    value = negative ? (int64_t)(0 - result) : (int64_t)result;
+    return true;
+}
+
+bool MeshParser::parseHeader(MeshData& mesh, int& nFaces) {
+    mesh.clear();
+
+    // cabecalho: numero de vertices e faces
+    int nVertices;
+    skipWhitespace();
+    if (!readInt(nVertices, "numero de vertices")) return false;
+    skipWhitespace();
+    if (!readInt(nFaces, "numero de faces")) return false;
+    if (nVertices < 0 || nFaces < 0) {
+        return fail("numero de vertices e faces deve ser nao negativo");
+    }
+
+    return readCoordinates(nVertices, mesh.vertexX, mesh.vertexY);
+}
+
+bool MeshParser::readCoordinates(int count, std::vector<int64_t>& x, std::vector<int64_t>& y) {
+    // coordenadas: separadas por qualquer espaco em branco
+    x.resize(count);
+    y.resize(count);
+    for (int i = 0; i < count; i++) {
+        skipWhitespace();
+        if (!readInt64(x[i], "coordenada x")) return false;
+        skipWhitespace();
+        if (!readInt64(y[i], "coordenada y")) return false;
+    }
+    return true;
+}
+
+bool MeshParser::parsePoints(std::vector<int64_t>& x, std::vector<int64_t>& y) {
+    int count;
+    skipWhitespace();
+    if (!readInt(count, "numero de pontos")) return false;
+    if (count < 0) {
+        return fail("numero de pontos deve ser nao negativo");
+    }
+    return readCoordinates(count, x, y);
+}
+
+bool MeshParser::parseFace(std::vector<int>& faceVertices, int remainingFaces) {
+    // linhas em branco antes da face sao ignoradas
+    if (!skipWhitespace()) {
+        return fail("fim da entrada, faltam " + std::to_string(remainingFaces) + " faces");
+    }
+
+    for (int c = peek(); c >= 0 && c != '\n'; c = peek()) {
+        if (c == ' ' || c == '\t' || c == '\r') {
+            position++;
+            continue;
+        }
+        int vertexIndex;
+        if (!readInt(vertexIndex, "indice de vertice")) return false;
+        faceVertices.push_back(vertexIndex);
+    }
+    return true;
+}
+
+bool MeshParser::parse(MeshData& mesh) {
+    int nFaces;
+    if (!parseHeader(mesh, nFaces)) {
+        return false;
+    }
+
+    // faces: uma por linha
+    mesh.faceStart.reserve((size_t)nFaces + 1);
+    mesh.faceStart.push_back(0);
+    for (int f = 0; f < nFaces; f++) {
+        if (!parseFace(mesh.faceVertices, nFaces - f)) {
+            return false;
+        }
+        mesh.faceStart.push_back(mesh.faceVertices.size());
+    }
+    return true;
+}
+
+bool MeshParser::atEnd() {
+    return !skipWhitespace();
+}
+
+void MeshParser::releaseConsumed() {
+    if (!mapping) {
+        return;
+    }
+    size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+    size_t end = position / pageSize * pageSize;
+    if (end > released) {
+        madvise(static_cast<char*>(mapping) + released, end - released, MADV_DONTNEED);
+        released = end;
+    }
+}
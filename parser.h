@@ -0,0 +1,95 @@
+#ifndef PARSER_H
+#define PARSER_H
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+// malha lida da entrada, com as faces em formato compacto (CSR); as coordenadas
+// ficam em 64 bits e BasicDCEL as converte para a largura da sua instancia
+struct MeshData {
+    std::vector<int64_t> vertexX;
+    std::vector<int64_t> vertexY;
+    std::vector<size_t> faceStart;   // face f ocupa [faceStart[f], faceStart[f + 1]) de faceVertices
+    std::vector<int> faceVertices;   // indices dos vertices como na entrada (1-based)
+
+    size_t getVertexCount() const { return vertexX.size(); }
+    size_t getFaceCount() const { return faceStart.empty() ? 0 : faceStart.size() - 1; }
+    // menor e maior coordenada (x ou y); false sem vertices
+    bool coordinateRange(int64_t& low, int64_t& high) const;
+    void clear();
+
+    // solda os vertices de coordenadas iguais (weld.cpp): cada posicao fica com
+    // um so vertice, na ordem da primeira ocorrencia, e as faces sao renumeradas
+    // no lugar; arestas que a solda reduz a um ponto saem da face. O(n) com uma
+    // tabela de enderecamento aberto; devolve quantos vertices foram removidos
+    size_t weldVertices();
+};
+
+// leitor do formato de entrada: mapeia arquivos em memoria (mmap) e le a entrada
+// padrao em blocos quando ela nao eh um arquivo regular; os inteiros sao
+// convertidos manualmente e cada linha de face termina na quebra de linha
+class MeshParser {
+private:
+    const char* data = nullptr;
+    size_t size = 0;
+    size_t position = 0;
+    size_t line = 1;
+    void* mapping = nullptr;
+    size_t mappingSize = 0;
+    size_t released = 0;         // inicio do trecho mapeado ainda nao descartado
+    int sourceFd = -1;           // leitura em blocos quando nao ha mapeamento
+    bool ownsFd = false;
+    std::vector<char> buffer;
+    std::string error;
+
+    bool mapFile(int fd, bool owned);
+    bool refill();
+    bool fail(const std::string& message);
+    bool skipWhitespace();
+    bool readInt(int& value, const char* what);
+    bool readInt64(int64_t& value, const char* what);
+    bool readCoordinates(int count, std::vector<int64_t>& x, std::vector<int64_t>& y);
+
+    // proximo caractere (-1 no fim da entrada), reabastecendo o buffer se preciso
+    int peek() {
+        if (position == size && !refill()) return -1;
+        return (unsigned char)data[position];
+    }
+
+public:
+    MeshParser() = default;
+    ~MeshParser();
+    MeshParser(const MeshParser&) = delete;
+    MeshParser& operator=(const MeshParser&) = delete;
+
+    bool openFile(const char* path);
+    bool openStdin();
+
+    // le a proxima malha a partir da posicao atual
+    bool parse(MeshData& mesh);
+
+    // leitura em partes: cabecalho e vertices (faceStart e faceVertices ficam
+    // vazios) e depois uma face por vez, acrescentando seus indices em faceVertices;
+    // remainingFaces (contando esta) so aparece na mensagem de fim prematuro
+    bool parseHeader(MeshData& mesh, int& nFaces);
+    bool parseFace(std::vector<int>& faceVertices, int remainingFaces);
+
+    // lista de pontos (consultas de localizacao): quantidade e depois um par
+    // de coordenadas por ponto
+    bool parsePoints(std::vector<int64_t>& x, std::vector<int64_t>& y);
+
+    // true quando so resta espaco em branco
+    bool atEnd();
+
+    // bytes de entrada ainda nao lidos (0 quando desconhecido, como em pipes)
+    size_t remainingBytes() const { return sourceFd < 0 ? size - position : 0; }
+
+    // devolve ao sistema as paginas mapeadas que ja foram lidas
+    void releaseConsumed();
+
+    const std::string& getError() const { return error; }
+};
+
+#endif
@@ -0,0 +1,184 @@
+#include "DCEL.h"
+#include "stats.h"
+#include <algorithm>
+
+// reordenacao por localidade: na ordem da entrada, vertices vizinhos no plano
+// costumam ficar longe nos vetores, e cada salto por origin, twin ou next da
+// validacao e dos percursos erra o cache. os vertices passam a seguir a curva
+// de Hilbert sobre a caixa envolvente e as half-edges ficam agrupadas por face,
+// com os ciclos na ordem original e as faces na ordem do seu primeiro vertice
+// na curva, entao faces vizinhas (e os twins entre elas) ficam proximas
+
+namespace {
+    const int HILBERT_BITS = 16;
+
+    // posicao de (x, y) na curva de Hilbert de 2^16 x 2^16 celulas
+    uint32_t hilbertKey(uint32_t x, uint32_t y) {
+        const uint32_t side = 1u << HILBERT_BITS;
+        uint32_t key = 0;
+        for (uint32_t s = side / 2; s > 0; s /= 2) {
+            uint32_t rx = (x & s) != 0;
+            uint32_t ry = (y & s) != 0;
+            key += s * s * ((3 * rx) ^ ry);
+            // gira o quadrante para que a curva continue no proximo nivel
+            if (ry == 0) {
+                if (rx == 1) {
+                    x = side - 1 - x;
+                    y = side - 1 - y;
+                }
+                std::swap(x, y);
+            }
+        }
+        return key;
+    }
+
+    // bits que a diferenca entre as coordenadas precisa, para reduzir a 16
+    template <typename Wide>
+    int spanBits(Wide span) {
+        int bits = 0;
+        while (span > 0) {
+            bits++;
+            span >>= 1;
+        }
+        return bits;
+    }
+}
+
+template <typename Coord>
+void BasicDCEL<Coord>::reorderForLocality() {
+    if (isReordered()) {
+        return;
+    }
+    Stats::Timer timer(Stats::REORDER);
+    using UnsignedWide = typename CoordinateTraits<Coord>::UnsignedWide;
+    size_t nVertices = vertexX.size();
+    size_t nHalfEdges = edgeOrigin.size();
+    if (nVertices == 0) {
+        return;
+    }
+
+    // coordenadas relativas ao canto da caixa, reduzidas a 16 bits por eixo
+    Coord minX = *std::min_element(vertexX.begin(), vertexX.end());
+    Coord minY = *std::min_element(vertexY.begin(), vertexY.end());
+    Coord maxX = *std::max_element(vertexX.begin(), vertexX.end());
+    Coord maxY = *std::max_element(vertexY.begin(), vertexY.end());
+    UnsignedWide span = std::max((UnsignedWide)((UnsignedWide)maxX - (UnsignedWide)minX),
+                                 (UnsignedWide)((UnsignedWide)maxY - (UnsignedWide)minY));
+    int shift = std::max(0, spanBits(span) - HILBERT_BITS);
+
+    // chave na parte alta e indice na baixa: a ordenacao desempata pela entrada
+    std::vector<uint64_t> order(nVertices);
+    for (uint32_t v = 0; v < nVertices; v++) {
+        uint32_t x = (uint32_t)(((UnsignedWide)vertexX.data()[v] - (UnsignedWide)minX) >> shift);
+        uint32_t y = (uint32_t)(((UnsignedWide)vertexY.data()[v] - (UnsignedWide)minY) >> shift);
+        order[v] = ((uint64_t)hilbertKey(x, y) << 32) | v;
+    }
+    std::sort(order.begin(), order.end());
+    std::vector<uint32_t> newVertex(nVertices);
+    std::vector<uint32_t> vertexFrom(nVertices);
+    for (uint32_t i = 0; i < nVertices; i++) {
+        vertexFrom[i] = (uint32_t)order[i];
+        newVertex[vertexFrom[i]] = i;
+    }
+
+    // as faces seguem o seu vertice mais cedo na curva; as half-edges sao
+    // distribuidas face a face por contagem, na ordem original dentro de cada face
+    size_t nFaces = faceEdge.size();
+    std::vector<uint32_t> faceRank(nFaces, NONE);
+    for (uint32_t he = 0; he < nHalfEdges; he++) {
+        uint32_t& rank = faceRank[edgeFace.data()[he]];
+        rank = std::min(rank, newVertex[edgeOrigin.data()[he]]);
+    }
+    order.resize(nFaces);
+    for (uint32_t f = 0; f < nFaces; f++) {
+        order[f] = ((uint64_t)faceRank[f] << 32) | f;
+    }
+    std::sort(order.begin(), order.end());
+    std::vector<uint32_t> faceStart(nFaces, 0);
+    for (uint32_t he = 0; he < nHalfEdges; he++) {
+        faceStart[edgeFace.data()[he]]++;
+    }
+    uint32_t offset = 0;
+    for (uint32_t i = 0; i < nFaces; i++) {
+        uint32_t f = (uint32_t)order[i];
+        uint32_t count = faceStart[f];
+        faceStart[f] = offset;
+        offset += count;
+    }
+    std::vector<uint32_t> newEdge(nHalfEdges);
+    std::vector<uint32_t> edgeFrom(nHalfEdges);
+    for (uint32_t he = 0; he < nHalfEdges; he++) {
+        uint32_t position = faceStart[edgeFace.data()[he]]++;
+        newEdge[he] = position;
+        edgeFrom[position] = he;
+    }
+
+    permute(newVertex, newEdge);
+    vertexSource.assign(vertexFrom.begin(), vertexFrom.end());
+    edgeSource.assign(edgeFrom.begin(), edgeFrom.end());
+}
+
+template <typename Coord>
+void BasicDCEL<Coord>::restoreInputOrder() {
+    std::vector<uint32_t> newVertex(vertexSource.begin(), vertexSource.end());
+    std::vector<uint32_t> newEdge(edgeSource.begin(), edgeSource.end());
+    permute(newVertex, newEdge);
+    vertexSource.clear();
+    edgeSource.clear();
+}
+
+template <typename Coord>
+void BasicDCEL<Coord>::permute(const std::vector<uint32_t>& newVertex,
+                               const std::vector<uint32_t>& newEdge) {
+    auto edgeIndex = [&](uint32_t he) { return he != NONE ? newEdge[he] : NONE; };
+
+    // leituras por data(): o operator[] nao constante copiaria um snapshot mapeado
+    std::vector<Coord> x(vertexX.size()), y(vertexY.size());
+    std::vector<uint32_t> incident(vertexEdge.size());
+    for (uint32_t v = 0; v < newVertex.size(); v++) {
+        x[newVertex[v]] = vertexX.data()[v];
+        y[newVertex[v]] = vertexY.data()[v];
+        incident[newVertex[v]] = edgeIndex(vertexEdge.data()[v]);
+    }
+    vertexX.assign(x.begin(), x.end());
+    vertexY.assign(y.begin(), y.end());
+    vertexEdge.assign(incident.begin(), incident.end());
+
+    for (uint32_t f = 0; f < faceEdge.size(); f++) {
+        if (faceEdge[f] != NONE) {
+            faceEdge[f] = newEdge[faceEdge[f]];
+        }
+    }
+
+    // uma coluna de half-edges por vez, para nao duplicar todas de uma vez
+    std::vector<uint32_t> column(edgeOrigin.size());
+    for (uint32_t he = 0; he < newEdge.size(); he++) {
+        column[newEdge[he]] = newVertex[edgeOrigin.data()[he]];
+    }
+    edgeOrigin.assign(column.begin(), column.end());
+    for (uint32_t he = 0; he < newEdge.size(); he++) {
+        column[newEdge[he]] = edgeFace.data()[he];
+    }
+    edgeFace.assign(column.begin(), column.end());
+    for (Column<uint32_t>* links : {&edgeTwin, &edgeNext, &edgePrev}) {
+        for (uint32_t he = 0; he < newEdge.size(); he++) {
+            column[newEdge[he]] = edgeIndex(links->data()[he]);
+        }
+        links->assign(column.begin(), column.end());
+    }
+
+    // a grade de edicao guarda indices de half-edges
+    edgeGrid.clear();
+}
+
+// instancias para cada largura de coordenada (coordinate.h)
+#define INSTANTIATE_REORDER(Coord)                                                      \
+    template void BasicDCEL<Coord>::reorderForLocality();                               \
+    template void BasicDCEL<Coord>::restoreInputOrder();                                \
+    template void BasicDCEL<Coord>::permute(const std::vector<uint32_t>&,               \
+                                            const std::vector<uint32_t>&);
+
+INSTANTIATE_REORDER(int16_t)
+INSTANTIATE_REORDER(int32_t)
+INSTANTIATE_REORDER(int64_t)
+#undef INSTANTIATE_REORDER
@@ -0,0 +1,373 @@
+#include "DCEL.h"
+#include "stats.h"
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// formato binario do snapshot (versao 1), na ordem de bytes do proprio host:
+// - cabecalho de 64 bytes, com a largura das coordenadas (0 em arquivos antigos,
+//   que sao todos de 4 bytes)
+// - colunas vertexX, vertexY, vertexEdge, faceEdge, edgeOrigin, edgeTwin,
+//   edgeFace, edgeNext e edgePrev, nessa ordem, cada uma alinhada em 64 bytes
+// - com FLAG_REORDERED, mais vertexSource e edgeSource (reorderForLocality)
+// o carregamento mapeia o arquivo e as colunas da DCEL passam a apontar para
+// ele, sem copiar nem reconstruir twins e cadeias. os indices sao conferidos
+// contra as contagens do cabecalho (e, em snapshot validado, as ligacoes entre
+// si) antes de qualquer acesso, entao um arquivo corrompido eh recusado em vez
+// de levar a leituras fora dos vetores
+
+namespace {
+    const char SNAPSHOT_MAGIC[8] = {'D', 'C', 'E', 'L', 'S', 'N', 'A', 'P'};
+    const uint32_t SNAPSHOT_VERSION = 1;
+    const uint32_t BYTE_ORDER_MARK = 0x01020304;
+    const size_t SNAPSHOT_ALIGN = 64;
+
+    // bits de flags
+    const uint32_t FLAG_OPEN = 1u << 0;
+    const uint32_t FLAG_NON_PLANAR = 1u << 1;
+    const uint32_t FLAG_VALIDATED = 1u << 2;
+    const uint32_t FLAG_REORDERED = 1u << 3;
+
+    struct SnapshotHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrder;
+        uint64_t vertexCount;
+        uint64_t faceCount;
+        uint64_t halfEdgeCount;
+        uint32_t flags;
+        uint32_t coordinateBytes;
+        uint32_t reserved[4];
+    };
+    static_assert(sizeof(SnapshotHeader) == SNAPSHOT_ALIGN, "cabecalho deve ocupar 64 bytes");
+
+    // confere identificacao e versao; a mensagem cita o arquivo
+    bool checkHeader(const SnapshotHeader& header, const char* path) {
+        if (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0) {
+            fprintf(stderr, "erro: %s: nao eh um snapshot de DCEL\n", path);
+            return false;
+        }
+        if (header.version != SNAPSHOT_VERSION || header.byteOrder != BYTE_ORDER_MARK) {
+            fprintf(stderr, "erro: %s: versao ou ordem de bytes incompativel\n", path);
+            return false;
+        }
+        return true;
+    }
+
+    uint32_t coordinateBytes(const SnapshotHeader& header) {
+        return header.coordinateBytes != 0 ? header.coordinateBytes : 4;
+    }
+
+    size_t alignUp(size_t n) {
+        return (n + SNAPSHOT_ALIGN - 1) & ~(SNAPSHOT_ALIGN - 1);
+    }
+
+    template <typename T>
+    bool writeColumn(FILE* file, const Column<T>& column, size_t& offset) {
+        static const char padding[SNAPSHOT_ALIGN] = {};
+        size_t bytes = column.size() * sizeof(T);
+        if (bytes > 0 && fwrite(column.data(), 1, bytes, file) != bytes) {
+            return false;
+        }
+        size_t gap = alignUp(offset + bytes) - (offset + bytes);
+        if (gap > 0 && fwrite(padding, 1, gap, file) != gap) {
+            return false;
+        }
+        offset += bytes + gap;
+        return true;
+    }
+
+    // todos os indices abaixo de limit (ou NONE, onde a ligacao pode faltar)
+    bool indicesBelow(const Column<uint32_t>& column, size_t limit, bool noneAllowed) {
+        const uint32_t* values = column.data();
+        for (size_t i = 0; i < column.size(); i++) {
+            if (values[i] >= limit && !(noneAllowed && values[i] == UINT32_MAX)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // permutacao de 0..n-1, como gravada por reorderForLocality
+    bool isPermutation(const Column<uint32_t>& column) {
+        std::vector<bool> seen(column.size(), false);
+        const uint32_t* values = column.data();
+        for (size_t i = 0; i < column.size(); i++) {
+            if (values[i] >= column.size() || seen[values[i]]) {
+                return false;
+            }
+            seen[values[i]] = true;
+        }
+        return true;
+    }
+
+    template <typename T>
+    void attachColumn(Column<T>& column, const char* base, size_t& offset, size_t count,
+                      const std::shared_ptr<const void>& owner) {
+        column.attach(reinterpret_cast<const T*>(base + offset), count, owner);
+        offset = alignUp(offset + count * sizeof(T));
+    }
+}
+
+template <typename Coord>
+bool BasicDCEL<Coord>::saveSnapshot(const char* path) const {
+    if (!freeFaces.empty()) {
+        fprintf(stderr, "erro: %s: faces vagas apos removeEdge, chame compact() antes\n", path);
+        return false;
+    }
+    // grava ao lado e troca com rename: o destino pode ser o proprio snapshot
+    // mapeado por loadSnapshot, e uma falha no meio nao deixa arquivo truncado
+    std::string temporary = std::string(path) + ".tmp";
+    FILE* file = fopen(temporary.c_str(), "wb");
+    if (!file) {
+        fprintf(stderr, "erro: %s: %s\n", temporary.c_str(), strerror(errno));
+        return false;
+    }
+
+    SnapshotHeader header = {};
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.vertexCount = getVertexCount();
+    header.faceCount = getFaceCount();
+    header.halfEdgeCount = getHalfEdgeCount();
+    // validate() aceita cadeias que nao fecham (twins na mesma direcao), e o
+    // carregamento so aceita o veredito gravado com todas as ligacoes; sem elas
+    // o snapshot sai sem FLAG_VALIDATED e a validacao eh refeita ao carregar
+    header.flags = (openEdges ? FLAG_OPEN : 0) |
+                   (nonPlanarEdges ? FLAG_NON_PLANAR : 0) |
+                   (validated && hasClosedLinks() ? FLAG_VALIDATED : 0) |
+                   (isReordered() ? FLAG_REORDERED : 0);
+    header.coordinateBytes = sizeof(Coord);
+
+    size_t offset = sizeof(header);
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              writeColumn(file, vertexX, offset) &&
+              writeColumn(file, vertexY, offset) &&
+              writeColumn(file, vertexEdge, offset) &&
+              writeColumn(file, faceEdge, offset) &&
+              writeColumn(file, edgeOrigin, offset) &&
+              writeColumn(file, edgeTwin, offset) &&
+              writeColumn(file, edgeFace, offset) &&
+              writeColumn(file, edgeNext, offset) &&
+              writeColumn(file, edgePrev, offset) &&
+              (!isReordered() || (writeColumn(file, vertexSource, offset) &&
+                                  writeColumn(file, edgeSource, offset))) &&
+              fflush(file) == 0 && fsync(fileno(file)) == 0;
+
+    if (fclose(file) != 0) {
+        ok = false;
+    }
+    if (ok && rename(temporary.c_str(), path) != 0) {
+        fprintf(stderr, "erro: %s: %s\n", path, strerror(errno));
+        unlink(temporary.c_str());
+        return false;
+    }
+    if (!ok) {
+        fprintf(stderr, "erro: %s: falha ao gravar snapshot\n", path);
+        unlink(temporary.c_str());
+    }
+    return ok;
+}
+
+template <typename Coord>
+bool BasicDCEL<Coord>::loadSnapshot(const char* path) {
+    Stats::Timer timer(Stats::SNAPSHOT_LOAD);
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "erro: %s: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(SnapshotHeader)) {
+        fprintf(stderr, "erro: %s: snapshot truncado\n", path);
+        close(fd);
+        return false;
+    }
+
+    size_t fileSize = (size_t)info.st_size;
+    void* mapping = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        fprintf(stderr, "erro: %s: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    // o mapeamento eh desfeito quando a ultima coluna deixa de usa-lo
+    std::shared_ptr<const void> owner(mapping, [fileSize](const void* p) {
+        munmap(const_cast<void*>(p), fileSize);
+    });
+
+    const char* base = static_cast<const char*>(mapping);
+    SnapshotHeader header;
+    memcpy(&header, base, sizeof(header));
+
+    if (!checkHeader(header, path)) {
+        return false;
+    }
+    if (coordinateBytes(header) != sizeof(Coord)) {
+        fprintf(stderr, "erro: %s: coordenadas de %u bits, esperado %zu\n", path,
+                coordinateBytes(header) * 8, sizeof(Coord) * 8);
+        return false;
+    }
+    if (header.vertexCount >= NONE || header.faceCount >= NONE || header.halfEdgeCount >= NONE) {
+        fprintf(stderr, "erro: %s: snapshot corrompido\n", path);
+        return false;
+    }
+
+    size_t nVertices = header.vertexCount;
+    size_t nFaces = header.faceCount;
+    size_t nHalfEdges = header.halfEdgeCount;
+
+    // confere o tamanho antes de apontar as colunas para o arquivo
+    size_t expected = sizeof(header);
+    expected = alignUp(expected + nVertices * sizeof(Coord));
+    expected = alignUp(expected + nVertices * sizeof(Coord));
+    expected = alignUp(expected + nVertices * sizeof(uint32_t));
+    expected = alignUp(expected + nFaces * sizeof(uint32_t));
+    expected += 5 * alignUp(nHalfEdges * sizeof(uint32_t));
+    bool reordered = (header.flags & FLAG_REORDERED) != 0;
+    if (reordered) {
+        expected = alignUp(expected + nVertices * sizeof(uint32_t));
+        expected += alignUp(nHalfEdges * sizeof(uint32_t));
+    }
+    if (fileSize < expected) {
+        fprintf(stderr, "erro: %s: snapshot truncado\n", path);
+        return false;
+    }
+
+    size_t offset = sizeof(header);
+    attachColumn(vertexX, base, offset, nVertices, owner);
+    attachColumn(vertexY, base, offset, nVertices, owner);
+    attachColumn(vertexEdge, base, offset, nVertices, owner);
+    attachColumn(faceEdge, base, offset, nFaces, owner);
+    attachColumn(edgeOrigin, base, offset, nHalfEdges, owner);
+    attachColumn(edgeTwin, base, offset, nHalfEdges, owner);
+    attachColumn(edgeFace, base, offset, nHalfEdges, owner);
+    attachColumn(edgeNext, base, offset, nHalfEdges, owner);
+    attachColumn(edgePrev, base, offset, nHalfEdges, owner);
+    if (reordered) {
+        attachColumn(vertexSource, base, offset, nVertices, owner);
+        attachColumn(edgeSource, base, offset, nHalfEdges, owner);
+    } else {
+        vertexSource.clear();
+        edgeSource.clear();
+    }
+
+    openEdges = (header.flags & FLAG_OPEN) != 0;
+    nonPlanarEdges = (header.flags & FLAG_NON_PLANAR) != 0;
+    validated = (header.flags & FLAG_VALIDATED) != 0;
+    resetEditState();
+    if (!checkLinks()) {
+        fprintf(stderr, "erro: %s: snapshot corrompido\n", path);
+        // nenhuma coluna fica apontando para o arquivo recusado
+        for (Column<uint32_t>* column : {&vertexEdge, &faceEdge, &edgeOrigin, &edgeTwin, &edgeFace,
+                                         &edgeNext, &edgePrev, &vertexSource, &edgeSource}) {
+            column->clear();
+        }
+        vertexX.clear();
+        vertexY.clear();
+        validated = false;
+        return false;
+    }
+    return true;
+}
+
+template <typename Coord>
+bool BasicDCEL<Coord>::checkLinks() const {
+    size_t nVertices = getVertexCount();
+    size_t nFaces = getFaceCount();
+    size_t nHalfEdges = getHalfEdgeCount();
+
+    // vertices isolados, faces sem ciclo e malhas abertas deixam ligacoes NONE
+    bool inRange = indicesBelow(vertexEdge, nHalfEdges, true) &&
+                   indicesBelow(faceEdge, nHalfEdges, true) &&
+                   indicesBelow(edgeOrigin, nVertices, false) &&
+                   indicesBelow(edgeTwin, nHalfEdges, true) &&
+                   indicesBelow(edgeFace, nFaces, false) &&
+                   indicesBelow(edgeNext, nHalfEdges, true) &&
+                   indicesBelow(edgePrev, nHalfEdges, true);
+    if (!inRange || (isReordered() && !(isPermutation(vertexSource) &&
+                                        isPermutation(edgeSource)))) {
+        return false;
+    }
+    // sem o veredito gravado, validate() o recalcula e aceita ligacoes ausentes
+    return !validated || hasClosedLinks();
+}
+
+template <typename Coord>
+bool BasicDCEL<Coord>::hasClosedLinks() const {
+    size_t nVertices = getVertexCount();
+    size_t nFaces = getFaceCount();
+    size_t nHalfEdges = getHalfEdgeCount();
+
+    // todas as ligacoes: twin involutivo, prev inverso de next (entao todo ciclo
+    // fecha e os percursos terminam) e a face constante ao longo de next
+    const uint32_t* origin = edgeOrigin.data();
+    const uint32_t* twinOf = edgeTwin.data();
+    const uint32_t* face = edgeFace.data();
+    const uint32_t* nextOf = edgeNext.data();
+    const uint32_t* prevOf = edgePrev.data();
+    for (size_t he = 0; he < nHalfEdges; he++) {
+        uint32_t twin = twinOf[he], next = nextOf[he];
+        if (twin == NONE || next == NONE || twinOf[twin] != he || twin == he ||
+            prevOf[next] != he || face[next] != face[he] || origin[next] != origin[twin]) {
+            return false;
+        }
+    }
+    for (size_t f = 0; f < nFaces; f++) {
+        if (faceEdge[f] == NONE || face[faceEdge[f]] != f) {
+            return false;
+        }
+    }
+    for (size_t v = 0; v < nVertices; v++) {
+        if (vertexEdge[v] != NONE && origin[vertexEdge[v]] != v) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool readSnapshotWidth(const char* path, CoordinateWidth& width) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "erro: %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    SnapshotHeader header;
+    ssize_t got = read(fd, &header, sizeof(header));
+    close(fd);
+    if (got != (ssize_t)sizeof(header)) {
+        fprintf(stderr, "erro: %s: snapshot truncado\n", path);
+        return false;
+    }
+    if (!checkHeader(header, path)) {
+        return false;
+    }
+
+    switch (coordinateBytes(header)) {
+        case 2: width = CoordinateWidth::BITS16; return true;
+        case 4: width = CoordinateWidth::BITS32; return true;
+        case 8: width = CoordinateWidth::BITS64; return true;
+        default:
+            fprintf(stderr, "erro: %s: snapshot corrompido\n", path);
+            return false;
+    }
+}
+
+// instancias para cada largura de coordenada (coordinate.h)
+#define INSTANTIATE_SNAPSHOT(Coord)                                     \
+    template bool BasicDCEL<Coord>::saveSnapshot(const char*) const;    \
+    template bool BasicDCEL<Coord>::loadSnapshot(const char*);
+
+INSTANTIATE_SNAPSHOT(int16_t)
+INSTANTIATE_SNAPSHOT(int32_t)
+INSTANTIATE_SNAPSHOT(int64_t)
+#undef INSTANTIATE_SNAPSHOT
@@ -0,0 +1,99 @@
+#include "stats.h"
+#include <cerrno>
+#include <cstring>
+#include <sys/resource.h>
+
+namespace Stats {
+    bool active = false;
+    double phaseMs[PHASE_COUNT] = {};
+    uint32_t phaseRuns[PHASE_COUNT] = {};
+    std::atomic<uint64_t> counters[COUNTER_COUNT] = {};
+
+    namespace {
+        const char* PHASE_NAMES[PHASE_COUNT] = {
+            "parse", "weld", "stream_build", "snapshot_load", "create_half_edges", "match_twins",
+            "link_chains", "reorder", "open_edges", "non_planar", "intersections", "diagnose",
+            "output"
+        };
+        const char* COUNTER_NAMES[COUNTER_COUNT] = {
+            "half_edges", "welded_vertices", "edge_lookups", "segment_pairs", "predicates"
+        };
+        const bool COUNTER_DETAILED[COUNTER_COUNT] = {false, false, true, true, true};
+
+        std::chrono::steady_clock::time_point started;
+
+        double totalMs() {
+            return std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - started).count();
+        }
+
+        // pico de memoria residente do processo, em KB
+        long peakRssKb() {
+            struct rusage usage;
+            return getrusage(RUSAGE_SELF, &usage) == 0 ? usage.ru_maxrss : -1;
+        }
+    }
+
+    void enable() {
+        active = true;
+        started = std::chrono::steady_clock::now();
+    }
+
+    void report(FILE* out) {
+        fprintf(out, "%-20s %12s\n", "fase", "tempo (ms)");
+        for (int p = 0; p < PHASE_COUNT; p++) {
+            if (phaseRuns[p] > 0) {
+                fprintf(out, "%-20s %12.3f\n", PHASE_NAMES[p], phaseMs[p]);
+            }
+        }
+        fprintf(out, "%-20s %12.3f\n", "total", totalMs());
+
+        for (int c = 0; c < COUNTER_COUNT; c++) {
+            if (COUNTER_DETAILED[c] && !DETAILED) {
+                fprintf(out, "%-20s %12s\n", COUNTER_NAMES[c], "-");
+            } else {
+                fprintf(out, "%-20s %12llu\n", COUNTER_NAMES[c],
+                        (unsigned long long)counters[c].load());
+            }
+        }
+        fprintf(out, "%-20s %12ld\n", "peak_rss_kb", peakRssKb());
+        if (!DETAILED) {
+            fprintf(out, "(contadores com - exigem compilar com make STATS=1)\n");
+        }
+    }
+
+    bool writeJson(const char* path) {
+        FILE* out = fopen(path, "w");
+        if (!out) {
+            fprintf(stderr, "erro: %s: %s\n", path, strerror(errno));
+            return false;
+        }
+
+        fprintf(out, "{\n  \"phases_ms\": {");
+        const char* separator = "";
+        for (int p = 0; p < PHASE_COUNT; p++) {
+            if (phaseRuns[p] > 0) {
+                fprintf(out, "%s\n    \"%s\": %.3f", separator, PHASE_NAMES[p], phaseMs[p]);
+                separator = ",";
+            }
+        }
+        fprintf(out, "\n  },\n  \"total_ms\": %.3f,\n  \"counters\": {", totalMs());
+        separator = "";
+        for (int c = 0; c < COUNTER_COUNT; c++) {
+            if (COUNTER_DETAILED[c] && !DETAILED) {
+                fprintf(out, "%s\n    \"%s\": null", separator, COUNTER_NAMES[c]);
+            } else {
+                fprintf(out, "%s\n    \"%s\": %llu", separator, COUNTER_NAMES[c],
+                        (unsigned long long)counters[c].load());
+            }
+            separator = ",";
+        }
+        fprintf(out, "\n  },\n  \"peak_rss_kb\": %ld\n}\n", peakRssKb());
+
+        if (fclose(out) != 0) {
+            fprintf(stderr, "erro: %s: falha ao gravar estatisticas\n", path);
+            return false;
+        }
+        return true;
+    }
+}
@@ -0,0 +1,100 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+// instrumentacao opcional (stats.cpp): tempo de cada fase, contadores e pico de
+// memoria, ligados por Stats::enable() (opcao --stats do malha). os tempos e os
+// contadores de fase custam uma comparacao por fase quando desligados; os
+// contadores dos lacos internos (tick) so existem compilando com -DDCEL_STATS
+// (make STATS=1) e somem por completo do codigo sem ele
+namespace Stats {
+#ifdef DCEL_STATS
+    constexpr bool DETAILED = true;
+#else
+    constexpr bool DETAILED = false;
+#endif
+
+    enum Phase {
+        PARSE,            // leitura do texto para MeshData
+        WELD,             // solda de vertices repetidos (--weld)
+        STREAM_BUILD,     // leitura e criacao das half-edges em paralelo (--stream)
+        SNAPSHOT_LOAD,
+        CREATE_HALF_EDGES,
+        MATCH_TWINS,      // inclui os vereditos de aberta e nao planar
+        LINK_CHAINS,
+        REORDER,          // renumeracao por localidade (--reorder)
+        OPEN_EDGES,
+        NON_PLANAR,
+        INTERSECTIONS,
+        DIAGNOSE,         // relatorio completo de defeitos (--diagnose)
+        OUTPUT,           // impressao da DCEL ou localizacao de pontos
+        PHASE_COUNT
+    };
+
+    enum Counter {
+        HALF_EDGES,       // half-edges criadas
+        WELDED_VERTICES,  // vertices removidos pela solda
+        EDGE_LOOKUPS,     // consultas de aresta no pareamento de twins (detalhado)
+        SEGMENT_PAIRS,    // pares de segmentos testados (detalhado)
+        PREDICATES,       // chamadas de Geometry::orientation (detalhado)
+        COUNTER_COUNT
+    };
+
+    extern bool active;
+    extern double phaseMs[PHASE_COUNT];
+    extern uint32_t phaseRuns[PHASE_COUNT];
+    extern std::atomic<uint64_t> counters[COUNTER_COUNT];
+
+    void enable();
+
+    // contador de fase, somado uma vez por chamada
+    inline void add(Counter counter, uint64_t amount) {
+        if (active) {
+            counters[counter].fetch_add(amount, std::memory_order_relaxed);
+        }
+    }
+
+    // contador de laco interno; sem DCEL_STATS nao gera codigo
+    inline void tick(Counter counter, uint64_t amount = 1) {
+        if (DETAILED) {
+            counters[counter].fetch_add(amount, std::memory_order_relaxed);
+        }
+    }
+
+    // soma a duracao do escopo (ou ate stop) na fase
+    class Timer {
+    private:
+        Phase phase;
+        bool running;
+        std::chrono::steady_clock::time_point start;
+
+    public:
+        explicit Timer(Phase phase) : phase(phase), running(active) {
+            if (running) {
+                start = std::chrono::steady_clock::now();
+            }
+        }
+        ~Timer() { stop(); }
+
+        void stop() {
+            if (running) {
+                phaseMs[phase] += std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - start).count();
+                phaseRuns[phase]++;
+                running = false;
+            }
+        }
+        Timer(const Timer&) = delete;
+        Timer& operator=(const Timer&) = delete;
+    };
+
+    // relatorio legivel (stderr) ou em JSON
+    void report(FILE* out);
+    bool writeJson(const char* path);
+}
+
+#endif
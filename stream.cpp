@@ -0,0 +1,361 @@
+#include "DCEL.h"
+#include "parser.h"
+#include "stats.h"
+#include <cstdio>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// construcao com memoria limitada: a leitura das faces (produtor) e a criacao das
+// half-edges (consumidor) rodam em threads separadas, trocando blocos de faces por
+// uma fila com numero fixo de buffers; os indices de cada bloco sao descartados
+// assim que suas half-edges existem, entao a malha textual nunca fica inteira em
+// memoria. os twins sao pareados na chegada por uma tabela com as arestas que
+// ainda esperam a outra half-edge
+
+namespace {
+    // indices por bloco e numero de blocos em circulacao
+    const size_t CHUNK_INDICES = size_t(1) << 18;
+    const size_t CHUNK_COUNT = 4;
+
+    // faces lidas pelo produtor, em formato compacto
+    struct FaceChunk {
+        std::vector<uint32_t> faceSize;
+        std::vector<int> indices;
+    };
+
+    // fila bloqueante entre as threads
+    template <typename T>
+    class BlockingQueue {
+    private:
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::deque<T> items;
+        bool closed = false;
+
+    public:
+        void push(T item) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                items.push_back(item);
+            }
+            changed.notify_one();
+        }
+
+        // espera um item; false quando a fila foi fechada e esvaziada
+        bool pop(T& item) {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [this] { return !items.empty() || closed; });
+            if (items.empty()) {
+                return false;
+            }
+            item = items.front();
+            items.pop_front();
+            return true;
+        }
+
+        void close() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                closed = true;
+            }
+            changed.notify_all();
+        }
+    };
+
+    // tabela de enderecamento aberto (sondagem linear) das arestas geometricas
+    // com uma unica half-edge ate agora; a remocao desloca os elementos seguintes
+    // para tras, sem marcas de removido
+    class PendingEdges {
+    private:
+        static constexpr uint64_t EMPTY = UINT64_MAX;
+
+        std::vector<uint64_t> keys;
+        std::vector<uint32_t> values;
+        size_t count = 0;
+        int bits = 0;
+
+        size_t home(uint64_t key) const {
+            return (size_t)((key * 0x9E3779B97F4A7C15ull) >> (64 - bits));
+        }
+
+        void grow() {
+            std::vector<uint64_t> oldKeys;
+            std::vector<uint32_t> oldValues;
+            oldKeys.swap(keys);
+            oldValues.swap(values);
+
+            bits = bits == 0 ? 16 : bits + 1;
+            keys.assign(size_t(1) << bits, EMPTY);
+            values.assign(size_t(1) << bits, DCELBase::NONE);
+            count = 0;
+            for (size_t i = 0; i < oldKeys.size(); i++) {
+                if (oldKeys[i] != EMPTY) {
+                    insert(oldKeys[i], oldValues[i]);
+                }
+            }
+        }
+
+    public:
+        size_t size() const { return count; }
+
+        void insert(uint64_t key, uint32_t value) {
+            if (2 * (count + 1) > keys.size()) {
+                grow();
+            }
+            size_t mask = keys.size() - 1;
+            size_t slot = home(key);
+            while (keys[slot] != EMPTY) {
+                slot = (slot + 1) & mask;
+            }
+            keys[slot] = key;
+            values[slot] = value;
+            count++;
+        }
+
+        // remove a aresta e devolve sua half-edge, ou NONE se ela nao estava na tabela
+        uint32_t take(uint64_t key) {
+            if (count == 0) {
+                return DCELBase::NONE;
+            }
+            size_t mask = keys.size() - 1;
+            size_t slot = home(key);
+            while (keys[slot] != key) {
+                if (keys[slot] == EMPTY) {
+                    return DCELBase::NONE;
+                }
+                slot = (slot + 1) & mask;
+            }
+            uint32_t value = values[slot];
+
+            // fecha o buraco trazendo de volta quem sondou por cima dele
+            size_t hole = slot;
+            for (size_t next = (hole + 1) & mask; keys[next] != EMPTY; next = (next + 1) & mask) {
+                size_t target = home(keys[next]);
+                if (((next - target) & mask) >= ((next - hole) & mask)) {
+                    keys[hole] = keys[next];
+                    values[hole] = values[next];
+                    hole = next;
+                }
+            }
+            keys[hole] = EMPTY;
+            count--;
+            return value;
+        }
+    };
+
+    // produtor: le as faces em blocos e os entrega ao consumidor
+    void readFaces(MeshParser& parser, int nFaces, BlockingQueue<FaceChunk*>& empty,
+                   BlockingQueue<FaceChunk*>& filled, std::string& error) {
+        FaceChunk* chunk = nullptr;
+        for (int f = 0; f < nFaces; f++) {
+            if (!chunk) {
+                empty.pop(chunk);
+                chunk->faceSize.clear();
+                chunk->indices.clear();
+            }
+
+            size_t before = chunk->indices.size();
+            if (!parser.parseFace(chunk->indices, nFaces - f)) {
+                error = parser.getError();
+                break;
+            }
+            chunk->faceSize.push_back((uint32_t)(chunk->indices.size() - before));
+
+            if (chunk->indices.size() >= CHUNK_INDICES) {
+                parser.releaseConsumed();
+                filled.push(chunk);
+                chunk = nullptr;
+            }
+        }
+        if (chunk) {
+            filled.push(chunk);
+        }
+        filled.close();
+    }
+}
+
+template <typename Coord>
+bool BasicDCEL<Coord>::loadFromInputStreaming(const char* path) {
+    MeshParser parser;
+    bool opened = path ? parser.openFile(path) : parser.openStdin();
+
+    MeshData mesh;
+    int nFaces = 0;
+    if (!opened || !parser.parseHeader(mesh, nFaces)) {
+        fprintf(stderr, "erro: %s\n", parser.getError().c_str());
+        return false;
+    }
+    return loadFromInputStreaming(parser, mesh, nFaces);
+}
+
+template <typename Coord>
+bool BasicDCEL<Coord>::loadFromInputStreaming(MeshParser& parser, MeshData& mesh, int nFaces) {
+    if (!checkCoordinates(mesh)) {
+        return false;
+    }
+
+    vertexX.assign(mesh.vertexX.begin(), mesh.vertexX.end());
+    vertexY.assign(mesh.vertexY.begin(), mesh.vertexY.end());
+    mesh.clear();
+    vertexEdge.assign(vertexX.size(), NONE);
+    faceEdge.assign((size_t)nFaces, NONE);
+    edgeOrigin.clear();
+    edgeFace.clear();
+    edgeTwin.clear();
+    edgeNext.clear();
+    edgePrev.clear();
+    vertexSource.clear();
+    edgeSource.clear();
+    validated = false;
+    resetEditState();
+    openEdges = false;
+    nonPlanarEdges = false;
+
+    // reserva pela formula de Euler (V - E + F = 2, com a face externa entre as
+    // faces), exata para uma subdivisao conexa; malhas fora disso crescem
+    // geometricamente a partir dela. em arquivo mapeado, cada indice ocupa ao
+    // menos 2 bytes do que falta ler, o que limita cabecalhos com contagens absurdas
+    size_t expectedEdges = 2 * (vertexX.size() + (size_t)nFaces);
+    if (parser.remainingBytes() > 0) {
+        expectedEdges = std::min(expectedEdges, parser.remainingBytes() / 2);
+    }
+    edgeOrigin.reserve(expectedEdges);
+    edgeFace.reserve(expectedEdges);
+    edgeTwin.reserve(expectedEdges);
+    edgeNext.reserve(expectedEdges);
+    edgePrev.reserve(expectedEdges);
+
+    std::vector<FaceChunk> pool(CHUNK_COUNT);
+    BlockingQueue<FaceChunk*> empty;
+    BlockingQueue<FaceChunk*> filled;
+    for (FaceChunk& chunk : pool) {
+        empty.push(&chunk);
+    }
+
+    Stats::Timer timer(Stats::STREAM_BUILD);
+    std::string error;
+    std::thread producer(readFaces, std::ref(parser), nFaces, std::ref(empty),
+                         std::ref(filled), std::ref(error));
+
+    PendingEdges pending;
+    std::vector<uint64_t> keys;
+    std::vector<uint32_t> sameDirectionOrigins;
+    uint32_t faceIdx = 0;
+
+    FaceChunk* chunk;
+    while (filled.pop(chunk)) {
+        uint32_t firstEdge = (uint32_t)edgeOrigin.size();
+        keys.clear();
+        const int* faceVertices = chunk->indices.data();
+        for (uint32_t numVertices : chunk->faceSize) {
+            addFaceHalfEdges(faceIdx++, faceVertices, numVertices, keys);
+            faceVertices += numVertices;
+        }
+        empty.push(chunk);
+
+        // pareia as novas half-edges com as que aguardam na tabela; enquanto a
+        // estrutura nao esta ligada, edgeNext guarda o destino de cada half-edge
+        edgeTwin.resize(edgeOrigin.size(), NONE);
+        edgeNext.resize(edgeOrigin.size(), NONE);
+        edgePrev.resize(edgeOrigin.size(), NONE);
+        for (size_t i = 0; i < keys.size(); i++) {
+            uint32_t he = firstEdge + (uint32_t)i;
+            uint32_t low = (uint32_t)(keys[i] >> 32);
+            uint32_t high = (uint32_t)keys[i];
+            edgeNext[he] = edgeOrigin[he] == low ? high : low;
+
+            uint32_t other = pending.take(keys[i]);
+            Stats::tick(Stats::EDGE_LOOKUPS);
+            if (other == NONE) {
+                pending.insert(keys[i], he);
+                continue;
+            }
+            edgeTwin[he] = other;
+            edgeTwin[other] = he;
+            if (edgeFace[he] == edgeFace[other]) {
+                openEdges = true;
+            }
+            if (edgeOrigin[he] == edgeOrigin[other]) {
+                sameDirectionOrigins.push_back(edgeOrigin[he]);
+            }
+        }
+    }
+    producer.join();
+    Stats::add(Stats::HALF_EDGES, edgeOrigin.size());
+
+    if (!error.empty()) {
+        fprintf(stderr, "erro: %s\n", error.c_str());
+        return false;
+    }
+
+    // sobras na tabela sao arestas com numero impar de half-edges; com todas
+    // pareadas, resta descobrir arestas tocadas por 4 ou mais faces
+    if (pending.size() > 0) {
+        openEdges = true;
+    } else if (!openEdges && hasRepeatedEdges()) {
+        openEdges = true;
+        nonPlanarEdges = true;
+    }
+    if (hasRepeatedOrigin(sameDirectionOrigins)) {
+        nonPlanarEdges = true;
+    }
+    timer.stop();
+
+    edgeNext.assign(edgeOrigin.size(), NONE);
+    edgePrev.assign(edgeOrigin.size(), NONE);
+    linkHalfEdgeChains();
+    return true;
+}
+
+template <typename Coord>
+bool BasicDCEL<Coord>::hasRepeatedEdges() {
+    // agrupa um representante de cada par twin pelo menor vertice da aresta
+    // (edgePrev serve de lista, edgeNext ainda guarda os destinos) e procura
+    // o mesmo maior vertice duas vezes no grupo
+    std::vector<uint32_t> groupStart(vertexX.size() + 1, 0);
+    for (uint32_t he = 0; he < edgeOrigin.size(); he++) {
+        if (edgeTwin[he] > he && edgeTwin[he] != NONE) {
+            groupStart[std::min(edgeOrigin[he], edgeNext[he]) + 1]++;
+        }
+    }
+    for (size_t v = 0; v < vertexX.size(); v++) {
+        groupStart[v + 1] += groupStart[v];
+    }
+
+    std::vector<uint32_t> position(groupStart.begin(), groupStart.end() - 1);
+    for (uint32_t he = 0; he < edgeOrigin.size(); he++) {
+        if (edgeTwin[he] > he && edgeTwin[he] != NONE) {
+            edgePrev[position[std::min(edgeOrigin[he], edgeNext[he])]++] = he;
+        }
+    }
+    position.clear();
+    position.shrink_to_fit();
+
+    std::vector<uint32_t> seenFrom(vertexX.size(), NONE);
+    for (uint32_t v = 0; v < vertexX.size(); v++) {
+        for (uint32_t i = groupStart[v]; i < groupStart[v + 1]; i++) {
+            uint32_t he = edgePrev[i];
+            uint32_t other = std::max(edgeOrigin[he], edgeNext[he]);
+            if (seenFrom[other] == v) {
+                return true;
+            }
+            seenFrom[other] = v;
+        }
+    }
+    return false;
+}
+
+// instancias para cada largura de coordenada (coordinate.h)
+#define INSTANTIATE_STREAM(Coord)                                                        \
+    template bool BasicDCEL<Coord>::loadFromInputStreaming(const char*);                \
+    template bool BasicDCEL<Coord>::loadFromInputStreaming(MeshParser&, MeshData&, int); \
+    template bool BasicDCEL<Coord>::hasRepeatedEdges();
+
+INSTANTIATE_STREAM(int16_t)
+INSTANTIATE_STREAM(int32_t)
+INSTANTIATE_STREAM(int64_t)
+#undef INSTANTIATE_STREAM
@@ -0,0 +1,286 @@
+#include "sweep.h"
+#include "geometry.h"
+#include "stats.h"
+#include <algorithm>
+#include <set>
+
+namespace Sweep {
+    namespace {
+        template <typename Coord>
+        bool lexLess(const BasicPoint<Coord>& a, const BasicPoint<Coord>& b) {
+            return a.x < b.x || (a.x == b.x && a.y < b.y);
+        }
+        
+        // lado de c em relacao a reta suporte de s (s.p -> s.q com s.p < s.q):
+        // 1 acima, -1 abaixo, 0 sobre a reta
+        // (Geometry::orientation devolve HORARIO quando c fica a esquerda de p->q)
+        template <typename Coord>
+        int side(const Segment<Coord>& s, const BasicPoint<Coord>& c) {
+            switch (Geometry::orientation(s.p, s.q, c)) {
+                case Geometry::Orientation::HORARIO: return 1;
+                case Geometry::Orientation::ANTIHORARIO: return -1;
+                default: return 0;
+            }
+        }
+        
+        // excecoes do teste par a par: vertices compartilhados e extremos coincidentes
+        template <typename Coord>
+        bool isExempt(const Segment<Coord>& a, const Segment<Coord>& b) {
+            return a.u == b.u || a.u == b.v || a.v == b.u || a.v == b.v ||
+                   a.p == b.p || a.p == b.q || a.q == b.p || a.q == b.q;
+        }
+        
+        // mesma reta suporte: ativos ao mesmo tempo, dois segmentos colineares
+        // se sobrepoem (ambos contem o ponto da varredura)
+        template <typename Coord>
+        bool collinear(const Segment<Coord>& a, const Segment<Coord>& b) {
+            return side(a, b.p) == 0 && side(a, b.q) == 0;
+        }
+        
+        // ordem vertical dos segmentos ativos na linha de varredura; a comparacao
+        // eh feita no inicio do segmento que entrou por ultimo, onde ambos estao
+        // ativos, entao nao depende da posicao atual da varredura. pontos (eventos
+        // de segmentos de comprimento zero) sao comparados pelo lado da reta
+        template <typename Coord>
+        struct StatusOrder {
+            using is_transparent = void;
+            
+            const std::vector<Segment<Coord>>* segments;
+            // segmentos que ja empataram com outro da mesma reta
+            std::vector<char>* overlapping;
+            
+            // < 0 quando a esta abaixo de b
+            int compare(int a, int b) const {
+                const Segment<Coord>& sa = (*segments)[a];
+                const Segment<Coord>& sb = (*segments)[b];
+                
+                if (lexLess(sb.p, sa.p)) {
+                    return -compare(b, a);
+                }
+                
+                int s = 0;
+                if (sa.p != sb.p) {
+                    s = side(sa, sb.p);
+                }
+                if (s == 0) {
+                    s = side(sa, sb.q);
+                }
+                if (s != 0) {
+                    return -s;
+                }
+                // colineares: desempata pelo indice para manter ordem estrita. a
+                // insercao compara o segmento novo com os dois vizinhos que ele
+                // recebe (estao no caminho da arvore), entao todo par adjacente
+                // na mesma reta passa por aqui e fica marcado
+                if (a != b) {
+                    (*overlapping)[a] = (*overlapping)[b] = 1;
+                }
+                return a < b ? -1 : (a > b ? 1 : 0);
+            }
+            
+            bool operator()(int a, int b) const {
+                return compare(a, b) < 0;
+            }
+            // segmento abaixo do ponto; os que passam pelo ponto nao ficam antes dele
+            bool operator()(int a, const BasicPoint<Coord>& point) const {
+                return side((*segments)[a], point) > 0;
+            }
+            bool operator()(const BasicPoint<Coord>& point, int a) const {
+                return side((*segments)[a], point) < 0;
+            }
+        };
+        
+        template <typename Coord>
+        struct Event {
+            BasicPoint<Coord> at;
+            int type;     // 0 = remocao, 1 = ponto, 2 = insercao
+            int segment;
+        };
+    }
+    
+    template <typename Coord>
+    bool hasIntersectionBruteForce(const std::vector<Segment<Coord>>& segments) {
+        // os pares de cada segmento i vao juntos para o teste em lote
+        Geometry::SegmentPairs<Coord> pairs;
+        std::vector<uint64_t> hits;
+        for (size_t i = 0; i < segments.size(); i++) {
+            const Segment<Coord>& a = segments[i];
+            pairs.clear();
+            for (size_t j = i + 1; j < segments.size(); j++) {
+                const Segment<Coord>& b = segments[j];
+                if (a.u == b.u || a.u == b.v || a.v == b.u || a.v == b.v) continue;
+                pairs.add(a.p, a.q, b.p, b.q);
+            }
+
+            Stats::tick(Stats::SEGMENT_PAIRS, pairs.size());
+            Geometry::segmentsIntersectBatch(pairs, hits);
+            for (uint64_t word : hits) {
+                if (word != 0) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+    
+    template <typename Coord>
+    bool hasIntersection(const std::vector<Segment<Coord>>& input) {
+        // normaliza cada segmento para comecar no extremo lexicograficamente menor
+        std::vector<Segment<Coord>> segments(input);
+        for (auto& s : segments) {
+            if (lexLess(s.q, s.p)) {
+                std::swap(s.p, s.q);
+                std::swap(s.u, s.v);
+            }
+        }
+        
+        // segmento de comprimento zero nao tem ordem vertical definida e vira um
+        // evento de ponto: so pode tocar o interior de um segmento ativo
+        std::vector<Event<Coord>> events;
+        events.reserve(segments.size() * 2);
+        for (size_t i = 0; i < segments.size(); i++) {
+            if (segments[i].p == segments[i].q) {
+                events.push_back({segments[i].p, 1, (int)i});
+                continue;
+            }
+            events.push_back({segments[i].p, 2, (int)i});
+            events.push_back({segments[i].q, 0, (int)i});
+        }
+        
+        // no mesmo ponto, remocoes, pontos e insercoes, nessa ordem: segmentos que
+        // terminam e comecam no mesmo ponto nunca coexistem (e sao excecao de
+        // qualquer forma), e o ponto so encontra os segmentos que passam por ele
+        std::sort(events.begin(), events.end(), [](const Event<Coord>& a, const Event<Coord>& b) {
+            if (a.at != b.at) return lexLess(a.at, b.at);
+            if (a.type != b.type) return a.type < b.type;
+            return a.segment < b.segment;
+        });
+        
+        using Status = std::set<int, StatusOrder<Coord>>;
+        std::vector<char> overlapping(segments.size(), 0);
+        Status status(StatusOrder<Coord>{&segments, &overlapping});
+        std::vector<typename Status::iterator> position(segments.size());
+        
+        // segmentos ativos colineares ficam contiguos na ordem (desempate pelo
+        // indice) e formam um bloco; um par excecao sobreposto dentro do bloco
+        // esconderia os demais dos vizinhos, entao a adjacencia vale entre blocos:
+        // todos os pares de dois blocos vizinhos e de cada bloco entre si sao
+        // testados. dois segmentos da mesma reta que ficam adjacentes sao
+        // marcados, na insercao pela comparacao e na remocao pelo teste do par
+        // (que so pode ser excecao, ou a sobreposicao ja eh a resposta); sem
+        // marcas os blocos tem um segmento e vale a varredura simples, entao os
+        // pares a mais ficam restritos aos segmentos sobrepostos
+        using Iterator = typename Status::iterator;
+        auto test = [&](int a, int b) {
+            Stats::tick(Stats::SEGMENT_PAIRS);
+            const Segment<Coord>& sa = segments[a];
+            const Segment<Coord>& sb = segments[b];
+            if (isExempt(sa, sb)) {
+                if (collinear(sa, sb)) {
+                    overlapping[a] = overlapping[b] = 1;
+                }
+                return false;
+            }
+            return Geometry::segmentsIntersect(sa.p, sa.q, sb.p, sb.q);
+        };
+        auto blockBegin = [&](Iterator it) {
+            const Segment<Coord>& s = segments[*it];
+            while (overlapping[*it] && it != status.begin() && collinear(s, segments[*std::prev(it)])) {
+                --it;
+            }
+            return it;
+        };
+        // fim do bloco de it (que pertence a ele)
+        auto blockEnd = [&](Iterator it) {
+            const Segment<Coord>& s = segments[*it];
+            bool marked = overlapping[*it];
+            ++it;
+            while (marked && it != status.end() && collinear(s, segments[*it])) {
+                ++it;
+            }
+            return it;
+        };
+        // s contra os segmentos de [begin, end)
+        auto testAgainst = [&](int s, Iterator begin, Iterator end) {
+            for (auto it = begin; it != end; ++it) {
+                if (*it != s && test(s, *it)) {
+                    return true;
+                }
+            }
+            return false;
+        };
+        // pares entre [begin, end) e [end, last)
+        auto testBlocks = [&](Iterator begin, Iterator end, Iterator last) {
+            for (auto it = begin; it != end; ++it) {
+                if (testAgainst(*it, end, last)) {
+                    return true;
+                }
+            }
+            return false;
+        };
+        
+        for (const Event<Coord>& event : events) {
+            if (event.type == 1) {
+                // o primeiro ativo que nao fica abaixo do ponto passa por ele se o
+                // ponto estiver na sua reta; como os extremos no ponto ja sairam ou
+                // ainda nao entraram, o ponto eh interior ao segmento
+                auto it = status.lower_bound(event.at);
+                if (it != status.end() && side(segments[*it], event.at) == 0) {
+                    return true;
+                }
+            } else if (event.type == 2) {
+                auto it = status.insert(event.segment).first;
+                position[event.segment] = it;
+                
+                auto next = std::next(it);
+                bool hasNext = next != status.end(), hasPrev = it != status.begin();
+                if (!overlapping[event.segment] && (!hasNext || !overlapping[*next]) &&
+                    (!hasPrev || !overlapping[*std::prev(it)])) {
+                    if ((hasNext && test(*it, *next)) || (hasPrev && test(*std::prev(it), *it))) {
+                        return true;
+                    }
+                    continue;
+                }
+                
+                // o novo segmento contra o proprio bloco e os blocos vizinhos
+                Iterator begin = blockBegin(it), end = blockEnd(it);
+                if (testAgainst(event.segment, begin, end) ||
+                    (begin != status.begin() &&
+                     testAgainst(event.segment, blockBegin(std::prev(begin)), begin)) ||
+                    (end != status.end() && testAgainst(event.segment, end, blockEnd(end)))) {
+                    return true;
+                }
+            } else {
+                auto it = position[event.segment];
+                auto next = std::next(it);
+                bool between = it != status.begin() && next != status.end();
+                if (!overlapping[event.segment] &&
+                    (!between || (!overlapping[*std::prev(it)] && !overlapping[*next]))) {
+                    // vizinhos do segmento removido passam a ser adjacentes
+                    if (between && test(*std::prev(it), *next)) {
+                        return true;
+                    }
+                    status.erase(it);
+                    continue;
+                }
+                
+                // saindo o ultimo segmento do bloco, os blocos vizinhos passam a ser
+                // adjacentes (e viram um so quando estao na mesma reta)
+                bool last = blockBegin(it) == it && blockEnd(it) == next;
+                status.erase(it);
+                if (last && between && testBlocks(blockBegin(std::prev(next)), next, blockEnd(next))) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+    
+    // instancias para cada largura de coordenada (coordinate.h)
+    template bool hasIntersection(const std::vector<Segment<int16_t>>&);
+    template bool hasIntersection(const std::vector<Segment<int32_t>>&);
+    template bool hasIntersection(const std::vector<Segment<int64_t>>&);
+    template bool hasIntersectionBruteForce(const std::vector<Segment<int16_t>>&);
+    template bool hasIntersectionBruteForce(const std::vector<Segment<int32_t>>&);
+    template bool hasIntersectionBruteForce(const std::vector<Segment<int64_t>>&);
+}
@@ -0,0 +1,33 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include "DCEL.h"  // for Point structure
+#include <vector>
+
+namespace Sweep {
+    // aresta geometrica com os indices (internos) dos vertices extremos
+    template <typename Coord>
+    struct Segment {
+        using Point = BasicPoint<Coord>;
+
+        Point p, q;
+        int u, v;
+        
+        Segment() : u(-1), v(-1) {}
+        Segment(const Point& p, const Point& q, int u, int v) : p(p), q(q), u(u), v(v) {}
+    };
+
+    // verifica se algum par de segmentos se intersecta (Shamos-Hoey, O(n log n))
+    // pares que compartilham vertice ou extremo com mesmas coordenadas sao ignorados,
+    // como no teste par a par de DCEL::hasIntersectingFaces; segmentos de
+    // comprimento zero e sobreposicoes colineares sao resolvidos na propria
+    // varredura, com o mesmo resultado de hasIntersectionBruteForce
+    template <typename Coord>
+    bool hasIntersection(const std::vector<Segment<Coord>>& segments);
+    
+    // mesmo criterio testando todos os pares, O(n^2)
+    template <typename Coord>
+    bool hasIntersectionBruteForce(const std::vector<Segment<Coord>>& segments);
+}
+
+#endif
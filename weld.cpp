@@ -0,0 +1,93 @@
+#include "parser.h"
+#include <cstdint>
+
+// solda na leitura: vertices repetidos (mesmas coordenadas, indices diferentes)
+// viram um so, antes da construcao. sem ela as arestas que chegam a posicoes
+// iguais por vertices diferentes nao compartilham extremo para os testes de
+// superposicao, e cada copia ocupa vertice e half-edges em todas as passadas
+
+namespace {
+    const uint32_t EMPTY = UINT32_MAX;
+
+    // posicao inicial de (x, y) em uma tabela de 2^bits entradas
+    size_t home(int64_t x, int64_t y, int bits) {
+        uint64_t h = (uint64_t)x * 0x9E3779B97F4A7C15ull;
+        h = (h ^ (h >> 29) ^ (uint64_t)y) * 0xBF58476D1CE4E5B9ull;
+        return (size_t)(h >> (64 - bits));
+    }
+}
+
+size_t MeshData::weldVertices() {
+    size_t n = vertexX.size();
+    if (n < 2) {
+        return 0;
+    }
+
+    // sondagem linear com no maximo metade da tabela ocupada; cada entrada guarda
+    // o indice novo, cujas coordenadas ja estao na posicao compactada
+    int bits = 1;
+    while ((size_t(1) << bits) < 2 * n) {
+        bits++;
+    }
+    std::vector<uint32_t> table(size_t(1) << bits, EMPTY);
+    size_t mask = table.size() - 1;
+    std::vector<uint32_t> remap(n);
+    uint32_t kept = 0;
+    for (size_t v = 0; v < n; v++) {
+        int64_t x = vertexX[v], y = vertexY[v];
+        size_t slot = home(x, y, bits);
+        while (table[slot] != EMPTY && (vertexX[table[slot]] != x || vertexY[table[slot]] != y)) {
+            slot = (slot + 1) & mask;
+        }
+        if (table[slot] == EMPTY) {
+            // kept <= v: a posicao compactada ja foi lida
+            vertexX[kept] = x;
+            vertexY[kept] = y;
+            table[slot] = kept++;
+        }
+        remap[v] = table[slot];
+    }
+
+    size_t merged = n - kept;
+    if (merged == 0) {
+        return 0;
+    }
+    vertexX.resize(kept);
+    vertexY.resize(kept);
+
+    // renumera as faces no lugar (1-based); indices fora do intervalo ficam como
+    // estao para a construcao reclamar deles. um canto repetido so sai quando os
+    // dois vertices eram diferentes na entrada, entao malhas que ja repetiam um
+    // indice continuam com o mesmo defeito
+    auto weldedIndex = [&](int index) {
+        return index >= 1 && (size_t)index <= n ? (int)remap[index - 1] + 1 : index;
+    };
+    size_t write = 0;
+    for (size_t f = 0; f + 1 < faceStart.size(); f++) {
+        size_t begin = faceStart[f], end = faceStart[f + 1];
+        size_t first = write;
+        faceStart[f] = write;
+        int firstOriginal = begin < end ? faceVertices[begin] : 0;
+        int previous = 0;
+        for (size_t i = begin; i < end; i++) {
+            int original = faceVertices[i];
+            int index = weldedIndex(original);
+            if (write > first && faceVertices[write - 1] == index && original != previous) {
+                previous = original;
+                continue;
+            }
+            faceVertices[write++] = index;
+            previous = original;
+        }
+        // fechamento do ciclo: o ultimo canto soldado ao primeiro
+        if (write - first > 1 && faceVertices[write - 1] == faceVertices[first] &&
+            firstOriginal != previous) {
+            write--;
+        }
+    }
+    if (!faceStart.empty()) {
+        faceStart.back() = write;
+    }
+    faceVertices.resize(write);
+    return merged;
+}
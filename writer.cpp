@@ -0,0 +1,24 @@
+#include "writer.h"
+#include <cerrno>
+#include <unistd.h>
+
+OutputBuffer::OutputBuffer(int fd, size_t capacity) : fd(fd), buffer(capacity) {}
+
+OutputBuffer::~OutputBuffer() {
+    flush();
+}
+
+bool OutputBuffer::flush() {
+    size_t written = 0;
+    while (written < used && !failed) {
+        ssize_t n = write(fd, buffer.data() + written, used - written);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            failed = true;
+        } else {
+            written += (size_t)n;
+        }
+    }
+    used = 0;
+    return !failed;
+}
@@ -0,0 +1,59 @@
+#ifndef WRITER_H
+#define WRITER_H
+
+#include <vector>
+#include <charconv>
+#include <cstring>
+#include <cstddef>
+
+// saida formatada com std::to_chars em um buffer grande reutilizado,
+// descarregado no descritor com poucas chamadas write
+class OutputBuffer {
+private:
+    int fd;
+    std::vector<char> buffer;
+    size_t used = 0;
+    bool failed = false;
+
+    // maior representacao decimal de um inteiro de 64 bits, com sinal
+    static const size_t MAX_NUMBER_CHARS = 20;
+
+    void reserve(size_t n) {
+        if (buffer.size() - used < n) {
+            flush();
+        }
+    }
+
+public:
+    explicit OutputBuffer(int fd, size_t capacity = size_t(1) << 20);
+    ~OutputBuffer();
+    OutputBuffer(const OutputBuffer&) = delete;
+    OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+    void put(char c) {
+        reserve(1);
+        buffer[used++] = c;
+    }
+
+    void put(const char* text) {
+        size_t length = strlen(text);
+        reserve(length);
+        if (length > buffer.size()) {
+            buffer.resize(length);
+        }
+        memcpy(buffer.data() + used, text, length);
+        used += length;
+    }
+
+    template <typename Integer>
+    void putNumber(Integer value) {
+        reserve(MAX_NUMBER_CHARS);
+        char* begin = buffer.data() + used;
+        used += std::to_chars(begin, begin + MAX_NUMBER_CHARS, value).ptr - begin;
+    }
+
+    // grava o conteudo pendente; false se alguma escrita falhou
+    bool flush();
+};
+
+#endif